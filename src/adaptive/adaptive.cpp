@@ -0,0 +1,80 @@
+#include "adaptive.h"
+
+#include "adaptive_tree.h"
+#include "../file_utils.h"
+
+#include <memory>
+#include <sstream>
+
+namespace huffman::adaptive
+{
+    constexpr size_t STREAM_BLOCK_SIZE = 1 << 16;
+
+    void encode_stream(std::istream& input, std::ostream& output) {
+        auto tree = std::make_unique<adaptiveTree>();
+        std::vector<byte> out_data;
+        auto writer = bitWriter(out_data);
+
+        //each read returns what the input has so far, so on a pipe the
+        //output of the symbols is written as soon as they arrive
+        std::vector<char> block(STREAM_BLOCK_SIZE);
+        while (input) {
+            auto count = read_available(input, block.data(), block.size());
+
+            for (std::streamsize i = 0; i < count; i++)
+                tree->encode(static_cast<byte>(block[i]), writer);
+
+            writer.flush(output);
+            output.flush();
+        }
+
+        tree->encode_end(writer);
+        writer.flush_all(output);
+        output.flush();
+    }
+
+    void decode_text(bitReader& reader, std::ostream& output) {
+        auto tree = std::make_unique<adaptiveTree>();
+        std::string block;
+        block.reserve(STREAM_BLOCK_SIZE);
+
+        for (auto character = tree->decode(reader); character != END_OF_STREAM; character = tree->decode(reader)) {
+            block.push_back(static_cast<char>(character));
+            if (block.size() == STREAM_BLOCK_SIZE) {
+                output << block;
+                block.clear();
+            }
+        }
+
+        output << block << std::flush;
+    }
+
+    void decode_stream(std::istream& input, std::ostream& output) {
+        auto reader = bitReader(input);
+        decode_text(reader, output);
+    }
+
+    std::vector<byte> encode(const std::string& text) {
+        auto tree = std::make_unique<adaptiveTree>();
+        std::vector<byte> out_data;
+        auto writer = bitWriter(out_data);
+
+        for (auto character : text)
+            tree->encode(static_cast<byte>(character), writer);
+        tree->encode_end(writer);
+
+        return out_data;
+    }
+
+    std::string decode(std::vector<byte>::const_iterator begin, std::vector<byte>::const_iterator end) {
+        auto reader = bitReader(begin, end);
+        auto text = std::ostringstream();
+        decode_text(reader, text);
+
+        return text.str();
+    }
+
+    std::string decode(const std::vector<byte>& encoded) {
+        return decode(encoded.cbegin(), encoded.cend());
+    }
+}
\ No newline at end of file
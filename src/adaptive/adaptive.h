@@ -0,0 +1,24 @@
+#ifndef HUFFMAN_ADAPTIVE
+#define HUFFMAN_ADAPTIVE
+
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "../definitions.h"
+
+namespace huffman::adaptive
+{
+    //one pass encoding: the input is read as it arrives and the output of each read
+    //is written before the next one, so no frequencies are needed upfront.
+    //decoding throws if the data ends before the end marker.
+    void encode_stream(std::istream& input, std::ostream& output);
+    void decode_stream(std::istream& input, std::ostream& output);
+
+    std::vector<byte> encode(const std::string& text);
+    std::string decode(std::vector<byte>::const_iterator begin, std::vector<byte>::const_iterator end);
+    std::string decode(const std::vector<byte>& encoded);
+}
+
+#endif
\ No newline at end of file
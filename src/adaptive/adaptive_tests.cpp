@@ -0,0 +1,100 @@
+#include "adaptive.h"
+#include "adaptive_tree.h"
+
+#include "../test_utils.h"
+
+#include <sstream>
+
+using namespace huffman::adaptive;
+
+void assertRoundTrip(const std::string& text) {
+    auto encoded = encode(text);
+    auto decoded = decode(encoded);
+    assert(decoded == text, "Round trip failed for a text of ", text.size(), " characters.");
+}
+
+void testRoundTrip() {
+    assertRoundTrip("");
+    assertRoundTrip("a");
+    assertRoundTrip(std::string(10000, 'a'));
+    assertRoundTrip("this is an example of a huffman tree");
+
+    std::string all_characters;
+    for (size_t repeat = 0; repeat < 4; repeat++)
+        for (size_t i = 0; i < TABLE_SIZE; i++)
+            all_characters.push_back(static_cast<char>(i));
+    assertRoundTrip(all_characters);
+}
+
+void testSkewedTextIsCompressed() {
+    std::string text;
+    for (size_t i = 0; i < 10000; i++)
+        text.push_back((i % 10 == 0) ? 'b' : 'a');
+
+    auto encoded = encode(text);
+    assert(encoded.size() < text.size() / 4, "Expected less than ", text.size() / 4, " bytes but found ", encoded.size());
+}
+
+void testStreamRoundTrip() {
+    //longer than a stream block, to cross the flushes
+    std::string text;
+    for (size_t i = 0; i < 200000; i++)
+        text.push_back(static_cast<char>((i * i + i / 7) % 91));
+
+    auto input = std::istringstream(text);
+    auto encoded = std::stringstream();
+    encode_stream(input, encoded);
+
+    auto expected = encode(text);
+    assert(encoded.str() == std::string(expected.begin(), expected.end()), "Stream and in memory encodings differ.");
+
+    auto decoded = std::ostringstream();
+    decode_stream(encoded, decoded);
+    assert(decoded.str() == text, "Stream round trip failed.");
+}
+
+//a stream cut before its end marker must not decode to a prefix of the text.
+void testTruncatedStreamFails() {
+    auto encoded = encode("this is an example of a huffman tree");
+    encoded.resize(encoded.size() / 2);
+
+    bool failed = false;
+    try {
+        decode(encoded);
+    } catch (const std::runtime_error&) {
+        failed = true;
+    }
+    assert(failed, "Expected a truncated stream to fail to decode.");
+}
+
+//a corrupt stream escaping the same character twice must not grow the tree past its nodes.
+void testRepeatedEscapeFails() {
+    std::vector<byte> encoded;
+    auto writer = bitWriter(encoded);
+
+    //the first escape has an empty path, the NYT leaf is then the left child of the root
+    writer.write_bits('a', ESCAPE_BITS);
+    for (size_t i = 0; i < 300; i++) {
+        writer.write(false);
+        writer.write_bits('a', ESCAPE_BITS);
+    }
+
+    //the stream has no end marker either, so it must fail on the second escape
+    auto message = std::string();
+    try {
+        decode(encoded);
+    } catch (const std::runtime_error& e) {
+        message = e.what();
+    }
+    assert(message == "The adaptive stream escapes a character it has already sent.",
+        "Expected a stream escaping a character twice to fail on the second escape, found \'", message, "\'");
+}
+
+void testMain()
+{
+    testRoundTrip();
+    testSkewedTextIsCompressed();
+    testStreamRoundTrip();
+    testTruncatedStreamFails();
+    testRepeatedEscapeFails();
+}
\ No newline at end of file
@@ -0,0 +1,126 @@
+#include "adaptive_tree.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace huffman::adaptive
+{
+    adaptiveTree::adaptiveTree() {
+        for (auto& node : nodes)
+            node = adaptiveNode{0, -1, -1, -1, -1};
+
+        for (auto& leaf : leaves)
+            leaf = -1;
+
+        nyt = ROOT;
+    }
+
+    void adaptiveTree::write_path(int node, bitWriter& writer) {
+        //the path is collected from the leaf upwards and written from the root
+        size_t length = 0;
+        for (; node != ROOT; node = nodes[node].parent)
+            path[length++] = nodes[nodes[node].parent].right == node;
+
+        while (length > 0)
+            writer.write(path[--length]);
+    }
+
+    int adaptiveTree::add_character(byte character) {
+        //the NYT leaf becomes the parent of the new NYT leaf and of the new character
+        auto parent = nyt;
+        auto leaf = parent - 1;
+        nyt = parent - 2;
+
+        nodes[parent].left = nyt;
+        nodes[parent].right = leaf;
+        nodes[nyt] = adaptiveNode{0, parent, -1, -1, -1};
+        nodes[leaf] = adaptiveNode{0, parent, -1, -1, character};
+        leaves[character] = leaf;
+
+        return leaf;
+    }
+
+    void adaptiveTree::swap_nodes(int first, int second) {
+        //positions (and thus parents) stay, the subtrees move
+        std::swap(nodes[first].weight, nodes[second].weight);
+        std::swap(nodes[first].left, nodes[second].left);
+        std::swap(nodes[first].right, nodes[second].right);
+        std::swap(nodes[first].character, nodes[second].character);
+
+        for (auto node : {first, second}) {
+            auto& moved = nodes[node];
+            if (moved.left != -1) {
+                nodes[moved.left].parent = node;
+                nodes[moved.right].parent = node;
+            } else if (moved.character != -1) {
+                leaves[moved.character] = node;
+            } else {
+                nyt = node;
+            }
+        }
+    }
+
+    void adaptiveTree::update(int node) {
+        while (node != -1) {
+            //move the node to the highest position of its weight class, unless that is its parent
+            auto leader = node;
+            for (auto i = node + 1; i < MAX_NODES && nodes[i].weight == nodes[node].weight; i++)
+                leader = i;
+
+            if (leader != node && leader != nodes[node].parent) {
+                swap_nodes(node, leader);
+                node = leader;
+            }
+
+            nodes[node].weight++;
+            node = nodes[node].parent;
+        }
+    }
+
+    void adaptiveTree::encode(byte character, bitWriter& writer) {
+        auto leaf = leaves[character];
+        if (leaf != -1) {
+            write_path(leaf, writer);
+        } else {
+            write_path(nyt, writer);
+            writer.write_bits(character, ESCAPE_BITS);
+            leaf = add_character(character);
+        }
+
+        update(leaf);
+    }
+
+    void adaptiveTree::encode_end(bitWriter& writer) {
+        write_path(nyt, writer);
+        writer.write_bits(END_OF_STREAM, ESCAPE_BITS);
+    }
+
+    size_t adaptiveTree::decode(bitReader& reader) {
+        auto node = ROOT;
+        while (nodes[node].left != -1) {
+            bool bit;
+            if (!reader.read(bit))
+                throw std::runtime_error("The adaptive stream ends before its end marker.");
+            node = bit ? nodes[node].right : nodes[node].left;
+        }
+
+        if (node == nyt) {
+            size_t character;
+            if (!reader.read_bits(character, ESCAPE_BITS))
+                throw std::runtime_error("The adaptive stream ends before its end marker.");
+            if (character > END_OF_STREAM)
+                throw std::runtime_error("The adaptive stream has an invalid escaped symbol.");
+            if (character == END_OF_STREAM)
+                return END_OF_STREAM;
+            if (leaves[character] != -1)
+                throw std::runtime_error("The adaptive stream escapes a character it has already sent.");
+
+            node = add_character(character);
+        }
+
+        auto character = nodes[node].character;
+        update(node);
+
+        return character;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#ifndef HUFFMAN_ADAPTIVE_TREE
+#define HUFFMAN_ADAPTIVE_TREE
+
+#include "bit_io.h"
+#include "../definitions.h"
+
+namespace huffman::adaptive
+{
+    //symbols sent after the escape code are one bit wider than a byte,
+    //so that the end of the stream can be told apart from any character.
+    constexpr size_t ESCAPE_BITS = 9;
+    constexpr size_t END_OF_STREAM = TABLE_SIZE;
+
+    //one leaf per character, the not yet transmitted (NYT) leaf and the internal nodes.
+    constexpr int MAX_NODES = 2 * (TABLE_SIZE + 1) - 1;
+    constexpr int ROOT = MAX_NODES - 1;
+
+    //FGK adaptive huffman tree, shared by the encoder and the decoder:
+    //both sides apply the same update after each symbol, so no table is ever transmitted.
+    //nodes are numbered by their position in the array, which keeps the sibling property
+    //(weights never decrease as the index grows) and makes the swaps constant time.
+    class adaptiveTree {
+    private:
+        struct adaptiveNode {
+            size_t weight;
+            int parent;
+            int left;
+            int right;
+            int character;
+        };
+
+        adaptiveNode nodes[MAX_NODES];
+        int leaves[TABLE_SIZE];
+        int nyt;
+        bool path[MAX_NODES];
+
+        void write_path(int node, bitWriter& writer);
+        int add_character(byte character);
+        void swap_nodes(int first, int second);
+        void update(int node);
+
+    public:
+        adaptiveTree();
+
+        void encode(byte character, bitWriter& writer);
+        void encode_end(bitWriter& writer);
+
+        //returns END_OF_STREAM at the end marker, throws when the data is over before it.
+        size_t decode(bitReader& reader);
+    };
+}
+
+#endif
\ No newline at end of file
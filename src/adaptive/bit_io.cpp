@@ -0,0 +1,41 @@
+#include "bit_io.h"
+
+#include "../file_utils.h"
+
+namespace huffman::adaptive
+{
+    constexpr size_t READ_BUFFER_SIZE = 1 << 16;
+
+    bitWriter::bitWriter(std::vector<byte>& data)
+        : data(data), last_bit(8) {}
+
+    void bitWriter::flush(std::ostream& output) {
+        if (data.empty()) return;
+
+        auto complete_bytes = (last_bit == 8) ? data.size() : data.size() - 1;
+        output.write(reinterpret_cast<char*>(data.data()), complete_bytes);
+        data.erase(data.begin(), data.begin() + complete_bytes);
+    }
+
+    void bitWriter::flush_all(std::ostream& output) {
+        output.write(reinterpret_cast<char*>(data.data()), data.size());
+        data.clear();
+        last_bit = 8;
+    }
+
+    bitReader::bitReader(std::istream& input)
+        : input(&input), position(0), next_bit(0) {}
+
+    bitReader::bitReader(std::vector<byte>::const_iterator begin, std::vector<byte>::const_iterator end)
+        : input(nullptr), buffer(begin, end), position(0), next_bit(0) {}
+
+    bool bitReader::refill() {
+        if (input == nullptr) return false;
+
+        buffer.resize(READ_BUFFER_SIZE);
+        buffer.resize(read_available(*input, reinterpret_cast<char*>(buffer.data()), buffer.size()));
+        position = 0;
+
+        return !buffer.empty();
+    }
+}
\ No newline at end of file
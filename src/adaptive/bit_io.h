@@ -0,0 +1,84 @@
+#ifndef HUFFMAN_ADAPTIVE_BIT_IO
+#define HUFFMAN_ADAPTIVE_BIT_IO
+
+#include <istream>
+#include <ostream>
+#include <vector>
+
+#include "../definitions.h"
+
+namespace huffman::adaptive
+{
+    //writes single bits, most significant first, into a byte array.
+    struct bitWriter {
+    private:
+        std::vector<byte>& data;
+        byte last_bit;
+
+    public:
+        bitWriter(std::vector<byte>& data);
+
+        inline void write(bool bit) {
+            if (last_bit == 8) {
+                data.push_back(0);
+                last_bit = 0;
+            }
+
+            data.back() |= bit << (7 - last_bit);
+            last_bit++;
+        }
+
+        inline void write_bits(size_t value, size_t bits) {
+            for (size_t i = bits; i > 0; i--)
+                write((value >> (i - 1)) & 1);
+        }
+
+        //moves the completed bytes to the output, keeping the last one if it is partial.
+        void flush(std::ostream& output);
+
+        //moves all the bytes to the output, padding the last one with zeros.
+        void flush_all(std::ostream& output);
+    };
+
+    //reads single bits, most significant first, from an array or a stream of bytes.
+    struct bitReader {
+    private:
+        std::istream* input;
+        std::vector<byte> buffer;
+        size_t position;
+        byte next_bit;
+
+        bool refill();
+
+    public:
+        bitReader(std::istream& input);
+        bitReader(std::vector<byte>::const_iterator begin, std::vector<byte>::const_iterator end);
+
+        //returns false once the data is over.
+        inline bool read(bool& bit) {
+            if (next_bit == 8) {
+                position++;
+                next_bit = 0;
+            }
+
+            if (position >= buffer.size() && !refill())
+                return false;
+
+            bit = (buffer[position] >> (7 - next_bit)) & 1;
+            next_bit++;
+            return true;
+        }
+
+        inline bool read_bits(size_t& value, size_t bits) {
+            value = 0;
+            for (size_t i = 0; i < bits; i++) {
+                bool bit;
+                if (!read(bit)) return false;
+                value = (value << 1) | bit;
+            }
+            return true;
+        }
+    };
+}
+
+#endif
\ No newline at end of file
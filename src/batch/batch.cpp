@@ -0,0 +1,200 @@
+#include "batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+#include <glob.h>
+
+#include "../file_utils.h"
+#include "../format.h"
+#include "../encoder/encoder.h"
+#include "../encoder/table_cache.h"
+#include "../decoder/decoder.h"
+#include "../adaptive/adaptive.h"
+#include "../tans/tans.h"
+#include "../threads/workerPool.h"
+
+namespace huffman::batch::detail
+{
+    struct batchJob {
+        std::string input_file;
+        std::string output_file;
+        size_t input_bytes;
+        size_t output_bytes;
+        std::string error;
+    };
+
+    std::vector<std::string> expand_glob(const std::string& pattern) {
+        glob_t matches;
+        auto result = glob(pattern.c_str(), 0, nullptr, &matches);
+        if (result == GLOB_NOMATCH) return {};
+        if (result != 0) throw std::runtime_error("Could not expand pattern \"" + pattern + "\".");
+
+        auto files = std::vector<std::string>(matches.gl_pathv, matches.gl_pathv + matches.gl_pathc);
+        globfree(&matches);
+        return files;
+    }
+
+    std::vector<std::string> read_list(const std::string& list_file) {
+        auto list = std::ifstream(list_file);
+        if (!list.is_open())
+            throw std::runtime_error("File list \"" + list_file + "\" does not exist.");
+
+        std::vector<std::string> files;
+        for (std::string line; std::getline(list, line);)
+            if (!line.empty()) files.push_back(line);
+
+        return files;
+    }
+
+    //inputs with the same name, from different directories, would write the same output file:
+    //none of them is coded.
+    void fail_shared_outputs(std::vector<batchJob>& jobs) {
+        auto outputs = std::map<std::string, size_t>();
+        for (auto& job : jobs)
+            outputs[job.output_file]++;
+
+        for (auto& job : jobs) {
+            auto inputs = outputs[job.output_file];
+            if (inputs > 1)
+                job.error = job.input_file + ": output file \"" + job.output_file + "\" is shared by " + std::to_string(inputs) + " input files.";
+        }
+    }
+
+    //without overwrite, the output file is created exclusively when it is written.
+    void run_job(batchJob& job, bool encode, size_t workers, bool overwrite) {
+        if (encode) {
+            auto text = read_text_file(job.input_file);
+            //small files, coded one per worker, share the tables of the process-wide cache
+            auto encoded_text = (workers > 1) ? encoder::encode_parallel_native(std::move(text), workers) : encoder::encode_cached(text);
+            encoded_text.insert(encoded_text.begin(), static_cast<byte>(formatTag::huffman));
+
+            write_binary_file(job.output_file, encoded_text.data(), encoded_text.size(), overwrite);
+            job.output_bytes = encoded_text.size();
+        } else {
+            auto tag = std::ifstream(job.input_file, std::ios::binary).get();
+            if (!is_format_tag(tag))
+                throw std::runtime_error("Not an encoded file.");
+
+            auto text = decode_tagged(static_cast<formatTag>(tag), read_binary_file(job.input_file, 1), workers);
+
+            write_binary_file(job.output_file, text.data(), text.size(), overwrite);
+            job.output_bytes = text.size();
+        }
+    }
+
+    void run_job_safe(batchJob& job, bool encode, size_t workers, bool overwrite) {
+        if (!job.error.empty()) return;
+
+        try {
+            run_job(job, encode, workers, overwrite);
+        } catch (const std::exception& e) {
+            job.error = job.input_file + ": " + e.what();
+        }
+    }
+}
+
+namespace huffman::batch
+{
+    std::vector<std::string> expand_inputs(const std::string& input) {
+        std::vector<std::string> files;
+        if (!input.empty() && input[0] == '@') {
+            files = detail::read_list(input.substr(1));
+        } else if (std::filesystem::is_directory(input)) {
+            for (auto& entry : std::filesystem::directory_iterator(input))
+                if (entry.is_regular_file()) files.push_back(entry.path().string());
+        } else {
+            files = detail::expand_glob(input);
+        }
+
+        std::sort(files.begin(), files.end());
+        return files;
+    }
+
+    std::string output_path(const std::string& input_file, const std::string& output_dir, bool encode) {
+        auto name = std::filesystem::path(input_file).filename().string();
+        auto extension = std::string(BATCH_EXTENSION);
+
+        if (encode) {
+            name += extension;
+        } else if (name.size() > extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0) {
+            name.resize(name.size() - extension.size());
+        }
+
+        return (std::filesystem::path(output_dir) / name).string();
+    }
+
+    std::string decode_tagged(formatTag tag, const std::vector<byte>& encoded_text, size_t workers) {
+        switch (tag) {
+            case formatTag::adaptive:
+                return adaptive::decode(encoded_text);
+            case formatTag::interleaved:
+                return decoder::decode_interleaved(encoded_text);
+            case formatTag::blocks:
+                return decoder::decode_blocks(encoded_text);
+            case formatTag::tans:
+                return tans::decode(encoded_text, workers);
+            case formatTag::pretrained:
+                throw std::runtime_error("Files encoded with a pretrained table cannot be decoded in a batch.");
+            default:
+                return decoder::decode(encoded_text);
+        }
+    }
+
+    batchReport run_batch(
+        const std::vector<std::string>& input_files,
+        const std::string& output_dir,
+        bool encode,
+        size_t workers,
+        bool overwrite,
+        size_t large_file_size
+    ) {
+        auto start = std::chrono::steady_clock::now();
+        std::filesystem::create_directories(output_dir);
+
+        std::vector<detail::batchJob> jobs;
+        for (auto& input_file : input_files) {
+            std::error_code error;
+            auto size = std::filesystem::file_size(input_file, error);
+            jobs.push_back({ input_file, output_path(input_file, output_dir, encode), error ? 0 : size, 0, "" });
+        }
+        detail::fail_shared_outputs(jobs);
+
+        //largest first, so that the last small files fill the gaps left by the others
+        std::stable_sort(jobs.begin(), jobs.end(), [](auto& a, auto& b) { return a.input_bytes > b.input_bytes; });
+        auto first_small = std::find_if(jobs.begin(), jobs.end(), [&](auto& job) { return job.input_bytes < large_file_size; }) - jobs.begin();
+
+        //large files (intra-file parallelism)
+        for (long i = 0; i < first_small; i++)
+            detail::run_job_safe(jobs[i], encode, workers, overwrite);
+
+        //small files (file-level parallelism)
+        if (static_cast<size_t>(first_small) < jobs.size()) {
+            auto pool = parallel::native::workerPool(std::min(workers, jobs.size() - first_small));
+            auto next = std::atomic<size_t>(first_small);
+            auto task = [&](size_t) {
+                for (auto i = next++; i < jobs.size(); i = next++)
+                    detail::run_job_safe(jobs[i], encode, 1, overwrite);
+            };
+            pool.run(task);
+        }
+
+        auto report = batchReport{ jobs.size(), 0, 0, 0, 0, {} };
+        for (auto& job : jobs) {
+            if (!job.error.empty()) {
+                report.failed++;
+                report.errors.push_back(job.error);
+            } else {
+                report.input_bytes += job.input_bytes;
+                report.output_bytes += job.output_bytes;
+            }
+        }
+
+        report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return report;
+    }
+}
\ No newline at end of file
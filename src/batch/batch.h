@@ -0,0 +1,43 @@
+#ifndef HUFFMAN_BATCH
+#define HUFFMAN_BATCH
+
+#include <string>
+#include <vector>
+
+#include "../definitions.h"
+#include "../format.h"
+
+namespace huffman::batch
+{
+    //the files named by a directory (its regular files), a list file (@file, one path per line)
+    //or a glob pattern, in lexicographic order.
+    std::vector<std::string> expand_inputs(const std::string& input);
+
+    //encoded files get the BATCH_EXTENSION extension in the output directory, which is removed when decoding.
+    std::string output_path(const std::string& input_file, const std::string& output_dir, bool encode);
+
+    //decodes the text following the tag byte of an encoded file.
+    std::string decode_tagged(formatTag tag, const std::vector<byte>& encoded_text, size_t workers = 1);
+
+    struct batchReport {
+        size_t files;
+        size_t failed;
+        size_t input_bytes;
+        size_t output_bytes;
+        double seconds;
+        std::vector<std::string> errors;
+    };
+
+    //files of at least large_file_size bytes are coded one at a time by all the workers,
+    //the smaller ones are spread over the workers, largest first, one file per worker.
+    batchReport run_batch(
+        const std::vector<std::string>& input_files,
+        const std::string& output_dir,
+        bool encode,
+        size_t workers,
+        bool overwrite = false,
+        size_t large_file_size = DEFAULT_BATCH_LARGE_FILE
+    );
+}
+
+#endif
\ No newline at end of file
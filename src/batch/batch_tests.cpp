@@ -0,0 +1,119 @@
+#include "batch.h"
+
+#include "../test_utils.h"
+
+#include "../file_utils.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace huffman;
+
+std::filesystem::path make_directory(const std::string& name) {
+    auto directory = std::filesystem::temp_directory_path() / ("huffman_batch_tests_" + name);
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    return directory;
+}
+
+std::string sample_text(size_t size, size_t seed) {
+    std::string text;
+    while (text.size() < size)
+        text += "line " + std::to_string(text.size() * seed % 1009) + " of sample " + std::to_string(seed) + "\n";
+
+    text.resize(size);
+    return text;
+}
+
+void write_file(const std::filesystem::path& path, const std::string& text) {
+    auto file = std::ofstream(path, std::ios::binary);
+    file.write(text.data(), text.size());
+}
+
+void testExpandInputs() {
+    auto directory = make_directory("expand");
+    write_file(directory / "b.txt", "b");
+    write_file(directory / "a.txt", "a");
+    write_file(directory / "c.log", "c");
+    std::filesystem::create_directories(directory / "nested");
+    write_file(directory / "list", (directory / "c.log").string() + "\n" + (directory / "a.txt").string() + "\n");
+
+    auto all = batch::expand_inputs(directory.string());
+    assert(all.size() == 4, "Expected the 4 regular files of the directory, found ", all.size());
+
+    auto matched = batch::expand_inputs((directory / "*.txt").string());
+    assert(matched.size() == 2 && matched[0] == (directory / "a.txt").string(), "Expected the glob to match a.txt and b.txt in order.");
+
+    auto listed = batch::expand_inputs("@" + (directory / "list").string());
+    assert(listed.size() == 2 && listed[1] == (directory / "c.log").string(), "Expected the two files of the list in order.");
+
+    std::filesystem::remove_all(directory);
+}
+
+void testOutputPath() {
+    assert(batch::output_path("in/a.txt", "out", true) == "out/a.txt.huf", "Expected the extension to be appended when encoding.");
+    assert(batch::output_path("out/a.txt.huf", "dec", false) == "dec/a.txt", "Expected the extension to be removed when decoding.");
+}
+
+void testRoundTrip() {
+    auto input = make_directory("input");
+    auto encoded = make_directory("encoded");
+    auto decoded = make_directory("decoded");
+
+    //the two largest files are above the threshold and are coded by all the workers
+    std::vector<std::string> texts;
+    for (size_t i = 0; i < 12; i++) {
+        texts.push_back(sample_text((i < 2) ? 300000 + i : 100 * i * i, i + 1));
+        write_file(input / ("file" + std::to_string(i)), texts.back());
+    }
+
+    auto report = batch::run_batch(batch::expand_inputs(input.string()), encoded.string(), true, 4, false, 200000);
+    assert(report.files == 12 && report.failed == 0, "Expected 12 files to be encoded, ", report.failed, " failed.");
+    assert(report.output_bytes < report.input_bytes, "Expected the batch to shrink the input.");
+
+    report = batch::run_batch(batch::expand_inputs(encoded.string()), decoded.string(), false, 4, false, 200000);
+    assert(report.files == 12 && report.failed == 0, "Expected 12 files to be decoded, ", report.failed, " failed.");
+
+    for (size_t i = 0; i < texts.size(); i++) {
+        auto text = read_text_file((decoded / ("file" + std::to_string(i))).string());
+        assert(text == texts[i], "Round trip failed for file ", i);
+    }
+
+    //existing outputs are reported as failures unless overwritten
+    report = batch::run_batch(batch::expand_inputs(input.string()), encoded.string(), true, 2);
+    assert(report.failed == 12, "Expected every existing output to fail, found ", report.failed, " failures.");
+
+    report = batch::run_batch(batch::expand_inputs(input.string()), encoded.string(), true, 2, true);
+    assert(report.failed == 0, "Expected existing outputs to be overwritten, found ", report.failed, " failures.");
+
+    std::filesystem::remove_all(input);
+    std::filesystem::remove_all(encoded);
+    std::filesystem::remove_all(decoded);
+}
+
+void testSharedOutputs() {
+    auto input = make_directory("shared_input");
+    auto encoded = make_directory("shared_encoded");
+    std::filesystem::create_directories(input / "nested");
+    write_file(input / "a.txt", sample_text(1000, 1));
+    write_file(input / "nested" / "a.txt", sample_text(1000, 2));
+    write_file(input / "b.txt", sample_text(1000, 3));
+
+    //both a.txt would be encoded to a.txt.huf
+    auto files = std::vector<std::string>{ (input / "a.txt").string(), (input / "nested" / "a.txt").string(), (input / "b.txt").string() };
+    auto report = batch::run_batch(files, encoded.string(), true, 2);
+    assert(report.files == 3 && report.failed == 2, "Expected the two inputs named a.txt to fail, found ", report.failed, " failures.");
+    assert(!std::filesystem::exists(encoded / "a.txt.huf"), "Expected no output for the inputs sharing it.");
+    assert(std::filesystem::exists(encoded / "b.txt.huf"), "Expected the other input to be encoded.");
+
+    std::filesystem::remove_all(input);
+    std::filesystem::remove_all(encoded);
+}
+
+void testMain()
+{
+    testExpandInputs();
+    testOutputPath();
+    testRoundTrip();
+    testSharedOutputs();
+}
\ No newline at end of file
@@ -0,0 +1,212 @@
+#include "corpus.h"
+
+#include "../encoder/encoder.h"
+#include "../decoder/decoder.h"
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+using namespace huffman;
+
+//end to end benchmark of the encoders over generated corpora, run by make bench.
+struct benchOptions {
+    std::vector<size_t> sizes;
+    std::vector<size_t> workers;
+    std::vector<std::string> corpora;
+    size_t repetitions;
+    std::string csv_file;
+    std::string json_file;
+};
+
+struct benchResult {
+    std::string corpus;
+    size_t size;
+    std::string mode;
+    size_t workers;
+    double encode_seconds;
+    double decode_seconds;
+    size_t encoded_bytes;
+    double speedup;
+};
+
+template<class Function>
+double median_seconds(size_t repetitions, Function run) {
+    std::vector<double> seconds(repetitions);
+    for (auto& time : seconds) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::sort(seconds.begin(), seconds.end());
+    return seconds[seconds.size() / 2];
+}
+
+//a copy of the input is the bandwidth ceiling of any pass over it.
+benchResult memcpy_baseline(const std::string& corpus, const std::string& text, size_t repetitions) {
+    std::string copy(text.size(), '\0');
+    auto seconds = median_seconds(repetitions, [&]() { std::memcpy(copy.data(), text.data(), text.size()); });
+
+    return { corpus, text.size(), "memcpy", 1, seconds, seconds, text.size(), 0 };
+}
+
+template<class Encoder>
+benchResult run_mode(const std::string& corpus, const std::string& text, const std::string& mode, size_t workers, size_t repetitions, Encoder encode) {
+    std::vector<byte> encoded;
+    auto encode_seconds = median_seconds(repetitions, [&]() { encoded = encode(); });
+
+    std::string decoded;
+    auto decode_seconds = median_seconds(repetitions, [&]() { decoded = decoder::decode(encoded); });
+    if (decoded != text)
+        throw std::runtime_error("The " + mode + " encoder does not round trip the " + corpus + " corpus.");
+
+    return { corpus, text.size(), mode, workers, encode_seconds, decode_seconds, encoded.size(), 0 };
+}
+
+inline double megabytes_per_second(size_t bytes, double seconds) {
+    return (seconds > 0) ? bytes / seconds / 1e6 : 0;
+}
+
+void write_csv(std::ostream& output, const std::vector<benchResult>& results) {
+    output << "corpus,size,mode,workers,encode_mbps,decode_mbps,ratio,speedup,efficiency\n";
+    for (auto& result : results) {
+        output << result.corpus << ',' << result.size << ',' << result.mode << ',' << result.workers << ','
+            << megabytes_per_second(result.size, result.encode_seconds) << ','
+            << megabytes_per_second(result.size, result.decode_seconds) << ','
+            << static_cast<double>(result.encoded_bytes) / result.size << ',';
+
+        //the baseline has no speedup
+        if (result.speedup > 0)
+            output << result.speedup << ',' << result.speedup / result.workers;
+        else
+            output << ',';
+        output << '\n';
+    }
+}
+
+void write_json(std::ostream& output, const std::vector<benchResult>& results) {
+    output << "[\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        auto& result = results[i];
+        output << "  {\"corpus\": \"" << result.corpus << "\", \"size\": " << result.size
+            << ", \"mode\": \"" << result.mode << "\", \"workers\": " << result.workers
+            << ", \"encode_mbps\": " << megabytes_per_second(result.size, result.encode_seconds)
+            << ", \"decode_mbps\": " << megabytes_per_second(result.size, result.decode_seconds)
+            << ", \"ratio\": " << static_cast<double>(result.encoded_bytes) / result.size;
+
+        if (result.speedup > 0)
+            output << ", \"speedup\": " << result.speedup << ", \"efficiency\": " << result.speedup / result.workers;
+        else
+            output << ", \"speedup\": null, \"efficiency\": null";
+        output << ((i + 1 < results.size()) ? "},\n" : "}\n");
+    }
+    output << "]\n";
+}
+
+//sizes take a K, M or G suffix (powers of 1024).
+size_t parse_size(const std::string& value) {
+    size_t end = 0;
+    auto size = std::stoull(value, &end);
+    if (end < value.size()) {
+        auto suffix = value[end];
+        size <<= (suffix == 'K') ? 10 : (suffix == 'M') ? 20 : (suffix == 'G') ? 30 : 0;
+    }
+
+    return size;
+}
+
+std::vector<std::string> split_list(const std::string& list) {
+    std::vector<std::string> values;
+    auto stream = std::istringstream(list);
+    for (std::string value; std::getline(stream, value, ',');)
+        if (!value.empty()) values.push_back(value);
+
+    return values;
+}
+
+benchOptions parse_bench_arguments(int argc, char** argv) {
+    auto options = benchOptions{ { 1 << 20, 16 << 20 }, {}, bench::corpus_names(), 3, "", "" };
+    for (size_t workers = 1; workers <= std::max(2u, std::thread::hardware_concurrency()); workers *= 2)
+        options.workers.push_back(workers);
+
+    for (int i = 1; i < argc; i++) {
+        auto arg = std::string(argv[i]);
+        if (i + 1 >= argc)
+            throw std::runtime_error("Expected a value after " + arg + ".");
+
+        auto value = std::string(argv[++i]);
+        if (arg == "--sizes") {
+            options.sizes.clear();
+            for (auto& size : split_list(value)) options.sizes.push_back(parse_size(size));
+            if (std::find(options.sizes.begin(), options.sizes.end(), 0) != options.sizes.end())
+                throw std::runtime_error("The sizes must be positive.");
+        } else if (arg == "--workers") {
+            options.workers.clear();
+            for (auto& workers : split_list(value)) options.workers.push_back(std::stoull(workers));
+        } else if (arg == "--corpora") {
+            options.corpora = split_list(value);
+        } else if (arg == "--repetitions") {
+            options.repetitions = std::max<size_t>(1, std::stoull(value));
+        } else if (arg == "--csv") {
+            options.csv_file = value;
+        } else if (arg == "--json") {
+            options.json_file = value;
+        } else {
+            throw std::runtime_error("Unrecognized argument " + arg + ".");
+        }
+    }
+
+    return options;
+}
+
+int main(int argc, char** argv)
+{
+    try {
+        auto options = parse_bench_arguments(argc, argv);
+
+        std::vector<benchResult> results;
+        for (auto size : options.sizes) {
+            for (auto& corpus : options.corpora) {
+                auto text = bench::generate_corpus(corpus, size);
+                std::cerr << "Benchmarking the " << corpus << " corpus, " << size << " bytes." << std::endl;
+
+                results.push_back(memcpy_baseline(corpus, text, options.repetitions));
+
+                auto sequential = run_mode(corpus, text, "sequential", 1, options.repetitions, [&]() { return encoder::encode(text); });
+                sequential.speedup = 1;
+                results.push_back(sequential);
+
+                for (auto workers : options.workers) {
+                    auto native = run_mode(corpus, text, "native", workers, options.repetitions,
+                        [&]() { return encoder::encode_parallel_native(text, workers); });
+                    auto fastflow = run_mode(corpus, text, "fastflow", workers, options.repetitions,
+                        [&]() { return encoder::encode_parallel_ff(text, workers); });
+
+                    for (auto result : { native, fastflow }) {
+                        result.speedup = sequential.encode_seconds / result.encode_seconds;
+                        results.push_back(result);
+                    }
+                }
+            }
+        }
+
+        write_csv(std::cout, results);
+        if (!options.csv_file.empty()) {
+            auto file = std::ofstream(options.csv_file);
+            write_csv(file, results);
+        }
+        if (!options.json_file.empty()) {
+            auto file = std::ofstream(options.json_file);
+            write_json(file, results);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,168 @@
+#ifndef HUFFMAN_BENCH_CORPUS
+#define HUFFMAN_BENCH_CORPUS
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace huffman::bench
+{
+    //splitmix64: unlike the standard distributions, it gives the same corpora on every platform.
+    class corpusRandom {
+    private:
+        uint64_t state;
+
+    public:
+        corpusRandom(uint64_t seed)
+            : state(seed) {}
+
+        inline uint64_t next() {
+            uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+            return z ^ (z >> 31);
+        }
+
+        //uniform in [0, 1)
+        inline double real() {
+            return (next() >> 11) * 0x1.0p-53;
+        }
+    };
+
+    //draws indexes with probabilities proportional to the given weights.
+    class weightedSampler {
+    private:
+        std::vector<double> cumulative;
+
+    public:
+        weightedSampler(const std::vector<double>& weights)
+            : cumulative(weights.size())
+        {
+            double total = 0;
+            for (size_t i = 0; i < weights.size(); i++)
+                cumulative[i] = (total += weights[i]);
+            for (auto& value : cumulative)
+                value /= total;
+        }
+
+        inline size_t sample(corpusRandom& random) const {
+            auto index = std::upper_bound(cumulative.begin(), cumulative.end(), random.real()) - cumulative.begin();
+            return std::min<size_t>(index, cumulative.size() - 1);
+        }
+    };
+
+    inline std::vector<double> zipf_weights(size_t symbols, double exponent) {
+        std::vector<double> weights(symbols);
+        for (size_t i = 0; i < symbols; i++)
+            weights[i] = 1.0 / std::pow(static_cast<double>(i + 1), exponent);
+
+        return weights;
+    }
+
+    inline std::string uniform_corpus(size_t size, corpusRandom& random) {
+        std::string text(size, '\0');
+        for (auto& character : text)
+            character = static_cast<char>(random.next() >> 56);
+
+        return text;
+    }
+
+    inline std::string zipf_corpus(size_t size, corpusRandom& random) {
+        auto sampler = weightedSampler(zipf_weights(256, 1.0));
+
+        std::string text(size, '\0');
+        for (auto& character : text)
+            character = static_cast<char>(sampler.sample(random));
+
+        return text;
+    }
+
+    //words of a fixed vocabulary drawn with Zipfian frequencies, with punctuation and line breaks.
+    inline std::string english_corpus(size_t size, corpusRandom& random) {
+        static const std::array<const char*, 48> vocabulary = {
+            "the", "of", "and", "to", "a", "in", "is", "it", "you", "that", "he", "was",
+            "for", "on", "are", "with", "as", "they", "be", "at", "one", "have", "this", "from",
+            "or", "had", "by", "word", "but", "what", "some", "we", "can", "out", "other", "were",
+            "all", "there", "when", "up", "use", "your", "how", "said", "each", "which", "their", "time"
+        };
+        auto sampler = weightedSampler(zipf_weights(vocabulary.size(), 1.1));
+
+        std::string text;
+        text.reserve(size + 16);
+        for (size_t words = 1; text.size() < size; words++) {
+            std::string word = vocabulary[sampler.sample(random)];
+            if (text.empty() || text.back() == '\n' || text[text.size() - 2] == '.')
+                word[0] = static_cast<char>(word[0] - 'a' + 'A');
+
+            text += word;
+            if (words % 97 == 0)
+                text += ".\n";
+            else if (words % 11 == 0)
+                text += ". ";
+            else if (words % 7 == 0)
+                text += ", ";
+            else
+                text += ' ';
+        }
+
+        text.resize(size);
+        return text;
+    }
+
+    //zeros, with one random byte every 64 on average.
+    inline std::string sparse_corpus(size_t size, corpusRandom& random) {
+        std::string text(size, '\0');
+        for (auto& character : text) {
+            auto value = random.next();
+            if ((value & 63) == 0) character = static_cast<char>(value >> 56);
+        }
+
+        return text;
+    }
+
+    inline std::string single_symbol_corpus(size_t size, corpusRandom&) {
+        return std::string(size, 'a');
+    }
+
+    //frequencies following the Fibonacci sequence give the deepest possible huffman tree.
+    inline std::string fibonacci_corpus(size_t size, corpusRandom& random) {
+        std::vector<double> weights = { 1, 1 };
+        while (weights.size() < 40)
+            weights.push_back(weights[weights.size() - 1] + weights[weights.size() - 2]);
+        auto sampler = weightedSampler(weights);
+
+        std::string text(size, '\0');
+        for (auto& character : text)
+            character = static_cast<char>('!' + sampler.sample(random));
+
+        return text;
+    }
+
+    inline const std::vector<std::string>& corpus_names() {
+        static const std::vector<std::string> names = { "uniform", "zipf", "english", "sparse", "single", "fibonacci" };
+        return names;
+    }
+
+    //the same name and size always give the same corpus.
+    inline std::string generate_corpus(const std::string& name, size_t size) {
+        uint64_t seed = size;
+        for (auto character : name)
+            seed = seed * 131 + static_cast<unsigned char>(character);
+        auto random = corpusRandom(seed);
+
+        if (name == "uniform") return uniform_corpus(size, random);
+        if (name == "zipf") return zipf_corpus(size, random);
+        if (name == "english") return english_corpus(size, random);
+        if (name == "sparse") return sparse_corpus(size, random);
+        if (name == "single") return single_symbol_corpus(size, random);
+        if (name == "fibonacci") return fibonacci_corpus(size, random);
+
+        throw std::runtime_error("Unknown corpus \"" + name + "\".");
+    }
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,70 @@
+#ifndef BENCH_UTILS
+#define BENCH_UTILS
+
+#ifndef TEST_FILE_NAME
+#define TEST_FILE_NAME "[unknown source file]"
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+#include <vector>
+
+//microbenchmark utilities: every benchmark is run a few times to warm the caches up, then
+//timed over HUFFMAN_BENCH_REPETITIONS runs (31 by default), reporting the median and the 99th percentile.
+constexpr size_t BENCH_WARMUP = 3;
+constexpr size_t DEFAULT_BENCH_REPETITIONS = 31;
+
+//keeps the compiler from optimizing away a result which is never read.
+template<typename T>
+inline void do_not_optimize(T const& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+inline size_t bench_repetitions() {
+    auto repetitions = std::getenv("HUFFMAN_BENCH_REPETITIONS");
+    return (repetitions == nullptr) ? DEFAULT_BENCH_REPETITIONS : std::max<size_t>(1, std::strtoull(repetitions, nullptr, 10));
+}
+
+//each run processes items items (bytes, symbols...), reported as nanoseconds per item and millions of items per second.
+template<typename Function>
+void benchmark(const std::string& name, size_t items, Function run) {
+    for (size_t i = 0; i < BENCH_WARMUP; i++)
+        run();
+
+    std::vector<double> nanoseconds(bench_repetitions());
+    for (auto& time : nanoseconds) {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        time = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    std::sort(nanoseconds.begin(), nanoseconds.end());
+    auto median = nanoseconds[nanoseconds.size() / 2];
+    auto p99 = nanoseconds[std::min(nanoseconds.size() - 1, nanoseconds.size() * 99 / 100)];
+    items = std::max<size_t>(items, 1);
+
+    printf("%-40s median %12.0f ns  p99 %12.0f ns  %8.3f ns/item  %10.2f M items/s\n",
+        name.c_str(), median, p99, median / items, items / median * 1e3);
+}
+
+void benchMain();
+int main()
+{
+    printf("%s - Start (%zu runs)\n", TEST_FILE_NAME, bench_repetitions());
+
+    try {
+        benchMain();
+    } catch (const std::exception& e) {
+        printf("Termination with exception: %s\n", e.what());
+        return 1;
+    }
+
+    printf("%s - Done\n", TEST_FILE_NAME);
+    return 0;
+}
+
+#endif
\ No newline at end of file
@@ -1,6 +1,7 @@
 #ifndef BIT_STREAM
 #define BIT_STREAM
 
+#include <cstddef>
 #include <vector>
 #include "definitions.h"
 
@@ -3,7 +3,13 @@
 #include "file_utils.h"
 
 inline void print_help() {
-    std::cout << "Usage: (--encode | --decode) <input file> <output file> [-p <number of threads> [--ff]] [--overwrite]\n";
+    std::cout << "Usage: (--encode | --decode) <input file> <output file> [-p <number of threads> [--ff | --ff-for [--grain <bytes>]]] [--sample <percent>] [--adaptive | --interleaved | --tans | --blocks [--block-size <bytes>] [--min-saving <percent>] [--ff] | --table <table file>] [--overwrite] [--direct-io]\n";
+    std::cout << "       --train <corpus file> <table file> [--overwrite]\n";
+    std::cout << "       (--encode | --decode) <input file> <output file> --socket <socket file> [--overwrite]\n";
+    std::cout << "       --daemon <socket file> [-p <number of threads> [--ff]] | --stop-daemon <socket file>\n";
+    std::cout << "       any of them takes [--profile] or [--profile-file <file>], timing its phases as a table on the standard error, or as JSON or CSV by the extension of the file.\n";
+    std::cout << "       an input or output file named - is the standard input or output, streamed in bounded memory by --blocks and --adaptive.\n";
+    std::cout << "       (--encode-batch | --decode-batch) (<directory> | @<file list> | <glob pattern>) <output directory> [-p <number of threads>] [--overwrite] [--direct-io]\n";
 }
 
 inline std::optional<programOptions> print_error(std::string message) {
@@ -12,9 +18,79 @@ inline std::optional<programOptions> print_error(std::string message) {
     return std::optional<programOptions>();
 }
 
+inline bool parse_number(int argc, char** argv, int& index, long long& out) {
+    if (index + 1 >= argc) return false;
+
+    index++;
+    auto number = std::string(argv[index]);
+    if (number.empty() || number.find_first_not_of("0123456789") != std::string::npos) return false;
+
+    out = std::atoll(number.c_str());
+    return true;
+}
+
+//--profile and --profile-file <file>, accepted by every command.
+bool parse_profile_argument(int argc, char** argv, int& i, programOptions& options, bool& valid)
+{
+    auto arg = std::string(argv[i]);
+    valid = true;
+    if (arg == "--profile") {
+        options.profile = true;
+    } else if (arg == "--profile-file") {
+        if (i + 1 >= argc) {
+            valid = false;
+        } else {
+            options.profile = true;
+            options.profile_file = std::string(argv[++i]);
+        }
+    } else {
+        return false;
+    }
+
+    return true;
+}
+
+//--daemon <socket file> [-p <number of threads> [--ff]] and --stop-daemon <socket file>.
+std::optional<programOptions> parse_service_arguments(int argc, char** argv)
+{
+    auto options = programOptions();
+    options.number_of_workers = 1;
+    options.overwrite_output = false;
+    options.profile = false;
+    options.socket_file = std::string(argv[2]);
+    options.encode = (std::string(argv[1]) == "--daemon") ? programMode::serve : programMode::stopServer;
+
+    long long number_of_threads = -1;
+    bool fastflow = false;
+    for (int i = 3; i < argc; i++) {
+        auto arg = std::string(argv[i]);
+        bool valid_profile = true;
+        if (parse_profile_argument(argc, argv, i, options, valid_profile)) {
+            if (!valid_profile)
+                return print_error("Error, expected a file after --profile-file.\n");
+        } else if (arg == "-p" && options.encode == programMode::serve) {
+            if (!parse_number(argc, argv, i, number_of_threads) || number_of_threads < 1)
+                return print_error("Error, expected number of threads after -p.\n");
+        } else if (arg == "--ff" && options.encode == programMode::serve) {
+            fastflow = true;
+        } else {
+            return print_error("Error, unrecognized command.\n");
+        }
+    }
+
+    if (fastflow && number_of_threads == -1)
+        return print_error("Error, --ff requires the number of threads (-p).\n");
+
+    if (number_of_threads != -1) options.number_of_workers = number_of_threads;
+    options.fastflow = fastflow;
+    return std::optional(options);
+}
+
 std::optional<programOptions> parse_arguments(int argc, char** argv)
 {
-    if (argc < 4 || argc > 8) {
+    if (argc >= 3 && (std::string(argv[1]) == "--daemon" || std::string(argv[1]) == "--stop-daemon")) {
+        return parse_service_arguments(argc, argv);
+    } else if (argc < 4) {
         print_help();
         return std::optional<programOptions>();
     } else {
@@ -23,25 +99,69 @@ std::optional<programOptions> parse_arguments(int argc, char** argv)
         auto encode_str = std::string(argv[1]);
         options.input_file = std::string(argv[2]);
         options.output_file = std::string(argv[3]);
+        options.number_of_workers = 1;
+        options.grain_size = DEFAULT_GRAIN_SIZE;
+        options.sample_percent = 100;
+        options.block_size = DEFAULT_BLOCK_SIZE;
+        options.min_saving_percent = DEFAULT_MIN_SAVING;
+        options.overwrite_output = false;
+        options.fastflow = false;
+        options.direct_io = false;
+        options.profile = false;
 
-        int number_of_threads = -1;
+        long long number_of_threads = -1;
+        long long grain_size = -1;
+        long long sample_percent = -1;
+        long long block_size = -1;
+        long long min_saving_percent = -1;
         auto ff_str = std::string();
-        auto overwrite_str = std::string();
-        if (argc > 4) {
-            auto arg4 = std::string(argv[4]);
-            if (arg4 == "-p" && argc > 5) {
-                number_of_threads = std::atoi(argv[5]);
-
-                if (argc == 7) {
-                    auto arg6 = std::string(argv[6]);
-                    if (arg6 == "--ff") ff_str = arg6;
-                    else overwrite_str = arg6;
-                } else if (argc == 8) {
-                    ff_str = std::string(argv[6]);
-                    overwrite_str = std::string(argv[7]);
-                }
+        auto format_str = std::string();
+        int profile_arguments = 0;
+        for (int i = 4; i < argc; i++) {
+            auto arg = std::string(argv[i]);
+            bool valid_profile = true;
+            auto first = i;
+            if (parse_profile_argument(argc, argv, i, options, valid_profile)) {
+                if (!valid_profile)
+                    return print_error("Error, expected a file after --profile-file.\n");
+                profile_arguments += i - first + 1;
+            } else if (arg == "-p") {
+                if (!parse_number(argc, argv, i, number_of_threads))
+                    return print_error("Error, expected number of threads after -p.\n");
+            } else if (arg == "--ff" || arg == "--ff-for") {
+                if (!ff_str.empty())
+                    return print_error("Error, only one of --ff and --ff-for can be specified.\n");
+                ff_str = arg;
+            } else if (arg == "--grain") {
+                if (!parse_number(argc, argv, i, grain_size) || grain_size < MIN_GRAIN_SIZE)
+                    return print_error("Error, expected a grain size of at least " + std::to_string(MIN_GRAIN_SIZE) + " bytes after --grain.\n");
+            } else if (arg == "--sample") {
+                if (!parse_number(argc, argv, i, sample_percent) || sample_percent < 1 || sample_percent > 100)
+                    return print_error("Error, expected a percentage between 1 and 100 after --sample.\n");
+            } else if (arg == "--block-size") {
+                if (!parse_number(argc, argv, i, block_size) || block_size < 1)
+                    return print_error("Error, expected a positive block size after --block-size.\n");
+            } else if (arg == "--min-saving") {
+                if (!parse_number(argc, argv, i, min_saving_percent) || min_saving_percent > 100)
+                    return print_error("Error, expected a percentage between 0 and 100 after --min-saving.\n");
+            } else if (arg == "--adaptive" || arg == "--interleaved" || arg == "--tans" || arg == "--blocks") {
+                if (!format_str.empty())
+                    return print_error("Error, only one of --adaptive, --interleaved, --tans and --blocks can be specified.\n");
+                format_str = arg;
+            } else if (arg == "--table") {
+                if (i + 1 >= argc)
+                    return print_error("Error, expected a table file after --table.\n");
+                options.table_file = std::string(argv[++i]);
+            } else if (arg == "--socket") {
+                if (i + 1 >= argc)
+                    return print_error("Error, expected a socket file after --socket.\n");
+                options.socket_file = std::string(argv[++i]);
+            } else if (arg == "--overwrite") {
+                options.overwrite_output = true;
+            } else if (arg == "--direct-io") {
+                options.direct_io = true;
             } else {
-                overwrite_str = arg4;
+                return print_error("Error, unrecognized command.\n");
             }
         }
 
@@ -51,38 +171,124 @@ std::optional<programOptions> parse_arguments(int argc, char** argv)
         } else if (encode_str == "--decode") {
             encode = false;
             options.encode = programMode::decode;
+        } else if (encode_str == "--train") {
+            encode = false;
+            options.encode = programMode::train;
+        } else if (encode_str == "--encode-batch" || encode_str == "--decode-batch") {
+            encode = false;
+            options.encode = (encode_str == "--encode-batch") ? programMode::encodeBatch : programMode::decodeBatch;
         } else {
             return print_error("Error, unrecognized command.\n");
         }
 
-        if (!file_exists(options.input_file))
+        //the input names many files and the output is a directory
+        if (options.encode == programMode::encodeBatch || options.encode == programMode::decodeBatch) {
+            if (!ff_str.empty() || !format_str.empty() || !options.table_file.empty() || !options.socket_file.empty()
+                || grain_size != -1 || sample_percent != -1 || block_size != -1 || min_saving_percent != -1)
+                return print_error("Error, batches only take -p, --overwrite and --direct-io.\n");
+            if (number_of_threads == 0)
+                return print_error("Error, unrecognized command.\n");
+            if (number_of_threads != -1) options.number_of_workers = number_of_threads;
+            return std::optional(options);
+        }
+
+        if (options.encode == programMode::train && (is_standard_stream(options.input_file) || is_standard_stream(options.output_file)))
+            return print_error("Error, --train reads and writes files only.\n");
+
+        if (!is_standard_stream(options.input_file) && !file_exists(options.input_file))
             return print_error("Error, specified input file does not exist.\n");
 
-        options.overwrite_output = false;
-        if (overwrite_str == "--overwrite")
-            options.overwrite_output = true;
-        else if (overwrite_str.size() != 0)
-            return print_error("Error, unrecognized command.\n");
-        
-        if (file_exists(options.output_file) && !options.overwrite_output)
+        if (!is_standard_stream(options.output_file) && file_exists(options.output_file) && !options.overwrite_output)
             return print_error("Error, specified output file already exists and would not be overwritten.\nSet the --overwrite flag to force overwrite.\n");
 
-        if (encode) {
+        if (options.encode == programMode::train) {
+            auto arguments = argc - profile_arguments;
+            if (arguments > 5 || (arguments == 5 && !options.overwrite_output))
+                return print_error("Error, --train only takes the corpus and the table file.\n");
+            return std::optional(options);
+        }
+
+        //the job is run by a daemon, with its own threads
+        if (!options.socket_file.empty()) {
+            if (!ff_str.empty() || !format_str.empty() || !options.table_file.empty() || grain_size != -1
+                || sample_percent != -1 || number_of_threads != -1)
+                return print_error("Error, --socket only takes --overwrite, the daemon sets the other options.\n");
+            options.encode = encode ? programMode::encode : programMode::decode;
+            return std::optional(options);
+        }
+
+        if (!options.table_file.empty() && !file_exists(options.table_file))
+            return print_error("Error, specified table file does not exist.\n");
+
+        if (grain_size != -1 && ff_str != "--ff-for")
+            return print_error("Error, --grain can only be used with --ff-for.\n");
+
+        if (sample_percent != -1) {
+            if (!encode || !ff_str.empty() || !format_str.empty())
+                return print_error("Error, --sample can only be used by the sequential and the native parallel encoders.\n");
+            options.sample_percent = sample_percent;
+        }
+
+        if ((block_size != -1 || min_saving_percent != -1) && format_str != "--blocks")
+            return print_error("Error, --block-size and --min-saving can only be used with --blocks.\n");
+
+        if (!format_str.empty() && !encode)
+            return print_error("Error, " + format_str + " is an encoding option, the decoder detects the format.\n");
+
+        if (number_of_threads == 0)
+            return print_error("Error, unrecognized command.\n");
+
+        if (!encode) {
+            //the tANS segments are decoded in parallel
+            if (number_of_threads != -1) options.number_of_workers = number_of_threads;
+        } else if (!options.table_file.empty()) {
+            if (!format_str.empty() || number_of_threads != -1 || !ff_str.empty() || sample_percent != -1)
+                return print_error("Error, --table is a single pass sequential encoder and takes no other option.\n");
+            options.encode = programMode::encodePretrained;
+        } else if (format_str == "--adaptive" || format_str == "--interleaved") {
+            if (number_of_threads != -1 || !ff_str.empty())
+                return print_error("Error, " + format_str + " is a sequential encoder.\n");
+            options.encode = (format_str == "--adaptive") ? programMode::encodeAdaptive : programMode::encodeInterleaved;
+        } else if (format_str == "--blocks") {
+            if (ff_str == "--ff-for")
+                return print_error("Error, --blocks supports --ff but not --ff-for.\n");
+            if (!ff_str.empty() && number_of_threads == -1)
+                return print_error("Error, --ff requires the number of threads (-p).\n");
+            if (number_of_threads != -1) options.number_of_workers = number_of_threads;
+            if (block_size != -1) options.block_size = block_size;
+            if (min_saving_percent != -1) options.min_saving_percent = min_saving_percent;
+            options.encode = ff_str.empty() ? programMode::encodeBlocks : programMode::encodeBlocksParallelFastFlow;
+        } else if (format_str == "--tans") {
+            if (ff_str == "--ff-for")
+                return print_error("Error, --tans supports --ff but not --ff-for.\n");
             if (number_of_threads == -1) {
+                if (!ff_str.empty())
+                    return print_error("Error, " + ff_str + " requires the number of threads (-p).\n");
+                options.encode = programMode::encodeTans;
+            } else {
+                options.number_of_workers = number_of_threads;
+                options.encode = ff_str.empty() ? programMode::encodeTansParallelNative : programMode::encodeTansParallelFastFlow;
+            }
+        } else {
+            if (number_of_threads == -1) {
+                if (!ff_str.empty())
+                    return print_error("Error, " + ff_str + " requires the number of threads (-p).\n");
                 options.encode = programMode::encode;
             } else if (number_of_threads < 1) {
                 return print_error("Error, unrecognized command.\n");
             } else if (ff_str.empty()) {
                 options.number_of_workers = number_of_threads;
                 options.encode = programMode::encodeParallelNative;
-            } else if (ff_str != "--ff") {
-                return print_error("Error, unrecognized command.\n");
-            } else {
+            } else if (ff_str == "--ff") {
                 options.number_of_workers = number_of_threads;
                 options.encode = programMode::encodeParallelFastFlow;
+            } else {
+                options.number_of_workers = number_of_threads;
+                if (grain_size != -1) options.grain_size = grain_size;
+                options.encode = programMode::encodeParallelFastFlowFor;
             }
         }
 
         return std::optional(options);
     }
-}
\ No newline at end of file
+}
@@ -4,19 +4,45 @@
 #include <optional>
 #include <string>
 
+#include "definitions.h"
+
 enum programMode {
     encode,
     decode,
     encodeParallelNative,
-    encodeParallelFastFlow
+    encodeParallelFastFlow,
+    encodeParallelFastFlowFor,
+    encodeAdaptive,
+    encodeInterleaved,
+    encodeTans,
+    encodeTansParallelNative,
+    encodeTansParallelFastFlow,
+    encodeBlocks,
+    encodeBlocksParallelFastFlow,
+    encodePretrained,
+    encodeBatch,
+    decodeBatch,
+    serve,
+    stopServer,
+    train
 };
 
 struct programOptions {
     programMode encode;
     size_t number_of_workers;
+    size_t grain_size;
+    size_t sample_percent;
+    size_t block_size;
+    size_t min_saving_percent;
     std::string input_file;
     std::string output_file;
+    std::string table_file;
+    std::string socket_file;
     bool overwrite_output;
+    bool fastflow;
+    bool direct_io;
+    bool profile;
+    std::string profile_file;
 };
 
 std::optional<programOptions> parse_arguments(int argc, char** argv);
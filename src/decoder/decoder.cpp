@@ -4,34 +4,55 @@
 #include "../bit_stream.h"
 #include "../utils.h"
 
-namespace huffman::decoder
+namespace huffman::decoder::detail
 {
-    std::string decode(const std::vector<byte>& encoded_text)
-    {
-        auto iter = encoded_text.cbegin();
-
-        //decode encodings
-        auto decoder = decoderTree(iter);
-
-        //get the number of characters
+    size_t read_text_metadata(std::vector<byte>::const_iterator& iter) {
         size_t number_of_characters = 0;
         auto size_bytes = reinterpret_cast<byte*>(&number_of_characters);
         for(size_t i = 0; i < sizeof(size_t); i++) {
             size_bytes[i] = *iter; iter++;
         }
 
-        //decode characters
+        return number_of_characters;
+    }
+
+    //decodes the characters starting at the given iterator, appending them to the output string.
+    void decode_text(
+        const decoderTree& decoder,
+        const std::vector<byte>& encoded_text,
+        std::vector<byte>::const_iterator iter,
+        size_t number_of_characters,
+        std::string& out_text
+    ) {
         auto offset = std::distance(encoded_text.cbegin(), iter);
 
         auto bit_stream = bitStream(encoded_text);
         bit_stream.advance(offset * 8);
 
-        auto string = std::string();
+        out_text.reserve(out_text.size() + number_of_characters);
         for(size_t i = 0; i < number_of_characters && bit_stream.hasNext(); i++) {
             auto character = decoder.decode(bit_stream);
-            string += character;
+            out_text += character;
         }
+    }
+}
+
+namespace huffman::decoder
+{
+    std::string decode(const std::vector<byte>& encoded_text)
+    {
+        auto iter = encoded_text.cbegin();
+
+        //decode encodings
+        auto decoder = decoderTree(iter);
+
+        //get the number of characters
+        auto number_of_characters = detail::read_text_metadata(iter);
+
+        //decode characters
+        auto string = std::string();
+        detail::decode_text(decoder, encoded_text, iter, number_of_characters, string);
 
         return string;
     }
-}
\ No newline at end of file
+}
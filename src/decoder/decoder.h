@@ -1,6 +1,8 @@
 #ifndef HUFFMAN_DECODER
 #define HUFFMAN_DECODER
 
+#include <istream>
+#include <ostream>
 #include <string>
 #include <vector>
 
@@ -9,6 +11,13 @@
 namespace huffman::decoder
 {
     std::string decode(const std::vector<byte>& encoded_text);
+
+    std::string decode_interleaved(const std::vector<byte>& encoded_text);
+
+    std::string decode_blocks(const std::vector<byte>& encoded_text);
+
+    //decodes the blocks as they are read, writing the text of each one before reading the next.
+    void decode_blocks(std::istream& input, std::ostream& output);
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,71 @@
+#include "decoder.h"
+#include "decoder_lookup.h"
+#include "decoder_tree.h"
+
+#include "../bench_utils.h"
+
+#include "../bench/corpus.h"
+#include "../encoder/encoder.h"
+#include "../encoder/encoder_table.h"
+
+using namespace huffman;
+using namespace huffman::decoder;
+
+namespace huffman::encoder::detail
+{
+    encoder::frequencyMap extract_frequencies(std::string::const_iterator, std::string::const_iterator);
+
+    std::vector<byte> encode_text(const encoder::encoderTable&, std::string::const_iterator, std::string::const_iterator, byte);
+}
+
+constexpr size_t BENCH_TEXT_SIZE = 4 << 20;
+
+void benchDecoder(const std::string& corpus) {
+    auto text = bench::generate_corpus(corpus, BENCH_TEXT_SIZE);
+    auto table = encoder::encoderTable(encoder::detail::extract_frequencies(text.cbegin(), text.cend()));
+    auto serialized = table.serialize();
+    auto encoded = encoder::detail::encode_text(table, text.cbegin(), text.cend(), 0);
+
+    benchmark("decoderTree (" + corpus + ")", 1, [&]() {
+        auto tree = decoderTree(serialized.cbegin());
+        do_not_optimize(tree);
+    });
+
+    auto tree = decoderTree(serialized.cbegin());
+    std::string decoded(text.size(), '\0');
+    benchmark("decoderTree::decode (" + corpus + ")", text.size(), [&]() {
+        auto bit_stream = bitStream(encoded);
+        for (auto& character : decoded)
+            character = tree.decode(bit_stream);
+        do_not_optimize(decoded);
+    });
+
+    if (decoded != text)
+        throw std::runtime_error("The " + corpus + " corpus was not decoded back.");
+
+    auto lookup = decoderLookup(serialized.cbegin());
+    benchmark("decoderLookup::decode (" + corpus + ")", text.size(), [&]() {
+        auto reader = lookupReader(encoded, 0);
+        for (auto& character : decoded)
+            character = lookup.decode(reader);
+        do_not_optimize(decoded);
+    });
+
+    if (decoded != text)
+        throw std::runtime_error("The " + corpus + " corpus was not decoded back by the lookup.");
+
+    auto interleaved = encoder::encode_interleaved(text);
+    benchmark("decode_interleaved (" + corpus + ")", text.size(), [&]() {
+        decoded = decode_interleaved(interleaved);
+        do_not_optimize(decoded);
+    });
+
+    if (decoded != text)
+        throw std::runtime_error("The " + corpus + " corpus was not decoded back from the interleaved format.");
+}
+
+void benchMain()
+{
+    for (auto corpus : { "english", "uniform", "fibonacci" })
+        benchDecoder(corpus);
+}
\ No newline at end of file
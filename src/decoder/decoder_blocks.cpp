@@ -0,0 +1,177 @@
+#include "decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <optional>
+
+#include "decoder_tree.h"
+#include "../format.h"
+#include "../utils.h"
+
+namespace huffman::decoder::detail
+{
+    size_t read_text_metadata(std::vector<byte>::const_iterator&);
+
+    void decode_text(const decoderTree&, const std::vector<byte>&, std::vector<byte>::const_iterator, size_t, std::string&);
+
+    //every byte of a packed block expands to the same 8 / width characters, so they
+    //are looked up in a table of the 256 possible bytes instead of being unpacked bit by bit.
+    //the payload must hold the alphabet and every packed character before the text grows.
+    void decode_packed(std::vector<byte>::const_iterator payload, size_t payload_size, size_t raw_size, std::string& out_text) {
+        if (payload_size == 0)
+            throw std::runtime_error("Packed block without a payload.");
+
+        size_t characters = *payload; payload++;
+        if (characters == 0 || characters > MAX_PACKED_CHARACTERS)
+            throw std::runtime_error("Invalid number of characters in a packed block.");
+
+        auto alphabet = std::array<char, MAX_PACKED_CHARACTERS>();
+        alphabet.fill('\0');
+        for (size_t i = 0; i < characters; i++) {
+            alphabet[i] = static_cast<char>(*payload); payload++;
+        }
+
+        auto width = packed_width(characters);
+        auto per_byte = 8 / width;
+        if (payload_size - 1 < characters || payload_size - 1 - characters < positive_div_ceil<size_t>(raw_size, per_byte))
+            throw std::runtime_error("Packed block of " + std::to_string(raw_size) + " characters with a payload of "
+                + std::to_string(payload_size) + " bytes.");
+
+        auto mask = (1 << width) - 1;
+        auto expansions = std::array<std::array<char, 8>, TABLE_SIZE>();
+        for (size_t value = 0; value < TABLE_SIZE; value++) {
+            for (size_t i = 0; i < per_byte; i++)
+                expansions[value][i] = alphabet[(value >> (8 - width * (i + 1))) & mask];
+        }
+
+        auto start = out_text.size();
+        out_text.resize(start + raw_size);
+        auto out = out_text.data() + start;
+
+        auto full_bytes = raw_size / per_byte;
+        for (size_t i = 0; i < full_bytes; i++, payload++, out += per_byte)
+            std::memcpy(out, expansions[*payload].data(), per_byte);
+
+        auto remaining = raw_size % per_byte;
+        if (remaining > 0)
+            std::memcpy(out, expansions[*payload].data(), remaining);
+    }
+
+    //stored blocks are copied as they are, constant blocks are filled with their character,
+    //huffman blocks carry their own table, which repeat blocks reuse.
+    void decode_block(
+        blockType type,
+        const std::vector<byte>& encoded_text,
+        std::vector<byte>::const_iterator payload,
+        size_t payload_size,
+        size_t raw_size,
+        std::optional<decoderTree>& previous_tree,
+        std::string& out_text
+    ) {
+        //every coded character takes at least one bit of the payload
+        if ((type == blockType::huffman || type == blockType::repeat) && raw_size / 8 > payload_size)
+            throw std::runtime_error("Coded block of " + std::to_string(raw_size) + " characters with a payload of "
+                + std::to_string(payload_size) + " bytes.");
+
+        switch (type) {
+            case blockType::stored: {
+                if (raw_size != payload_size)
+                    throw std::runtime_error("Stored block of " + std::to_string(raw_size) + " characters with a payload of "
+                        + std::to_string(payload_size) + " bytes.");
+
+                auto start = out_text.size();
+                out_text.resize(start + raw_size);
+                if (raw_size > 0) std::memcpy(out_text.data() + start, &*payload, raw_size);
+                break;
+            }
+            case blockType::constant:
+                if (payload_size != 1)
+                    throw std::runtime_error("Constant block with a payload of " + std::to_string(payload_size) + " bytes.");
+
+                out_text.append(raw_size, static_cast<char>(*payload));
+                break;
+            case blockType::packed:
+                decode_packed(payload, payload_size, raw_size, out_text);
+                break;
+            case blockType::huffman:
+                previous_tree.emplace(payload);
+                decode_text(*previous_tree, encoded_text, payload, raw_size, out_text);
+                break;
+            case blockType::repeat:
+                if (!previous_tree)
+                    throw std::runtime_error("Repeat block without a previous table.");
+                decode_text(*previous_tree, encoded_text, payload, raw_size, out_text);
+                break;
+            default:
+                throw std::runtime_error("Unknown block type " + std::to_string(static_cast<int>(type)) + ".");
+        }
+    }
+}
+
+namespace huffman::decoder
+{
+    std::string decode_blocks(const std::vector<byte>& encoded_text)
+    {
+        auto string = std::string();
+        auto iter = encoded_text.cbegin();
+        auto previous_tree = std::optional<decoderTree>();
+
+        while (true) {
+            if (encoded_text.cend() - iter < static_cast<long>(BLOCK_HEADER_SIZE))
+                throw std::runtime_error("Block file ends without an end block.");
+
+            auto type = static_cast<blockType>(*iter); iter++;
+            auto raw_size = detail::read_text_metadata(iter);
+            auto payload_size = detail::read_text_metadata(iter);
+            if (type == blockType::end) break;
+
+            if (static_cast<size_t>(encoded_text.cend() - iter) < payload_size)
+                throw std::runtime_error("Block payload goes past the end of the file.");
+
+            detail::decode_block(type, encoded_text, iter, payload_size, raw_size, previous_tree, string);
+            iter += payload_size;
+        }
+
+        return string;
+    }
+
+    //only one block, and its decoded text, are held in memory at a time.
+    void decode_blocks(std::istream& input, std::ostream& output)
+    {
+        auto header = std::vector<byte>(BLOCK_HEADER_SIZE);
+        auto payload = std::vector<byte>();
+        auto string = std::string();
+        auto previous_tree = std::optional<decoderTree>();
+
+        while (true) {
+            input.read(reinterpret_cast<char*>(header.data()), BLOCK_HEADER_SIZE);
+            if (static_cast<size_t>(input.gcount()) < BLOCK_HEADER_SIZE)
+                throw std::runtime_error("Block stream ends without an end block.");
+
+            auto iter = header.cbegin();
+            auto type = static_cast<blockType>(*iter); iter++;
+            auto raw_size = detail::read_text_metadata(iter);
+            auto payload_size = detail::read_text_metadata(iter);
+            if (type == blockType::end) break;
+
+            //the payload grows as its bytes arrive, so a corrupt size fails at the end of the
+            //stream instead of allocating it up front.
+            payload.clear();
+            while (payload.size() < payload_size) {
+                auto filled = payload.size();
+                auto chunk = std::min<size_t>(payload_size - filled, IO_BLOCK_SIZE);
+                payload.resize(filled + chunk);
+                input.read(reinterpret_cast<char*>(payload.data() + filled), chunk);
+                if (static_cast<size_t>(input.gcount()) < chunk)
+                    throw std::runtime_error("Block payload goes past the end of the stream.");
+            }
+
+            string.clear();
+            detail::decode_block(type, payload, payload.cbegin(), payload_size, raw_size, previous_tree, string);
+            output.write(string.data(), string.size());
+        }
+
+        output.flush();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,320 @@
+#include "decoder.h"
+
+#include "../test_utils.h"
+
+#include "../format.h"
+#include "../utils.h"
+#include "../encoder/encoder.h"
+
+#include <sstream>
+
+using namespace huffman;
+
+std::string random_text(size_t size, unsigned seed) {
+    std::string text;
+    for (size_t i = 0; i < size; i++) {
+        seed = seed * 1103515245 + 12345;
+        text.push_back(static_cast<char>(seed >> 16));
+    }
+
+    return text;
+}
+
+//counts the blocks of each type by walking the block headers.
+size_t count_blocks(const std::vector<byte>& encoded, blockType type) {
+    size_t count = 0;
+    size_t position = 0;
+    while (static_cast<blockType>(encoded[position]) != blockType::end) {
+        if (static_cast<blockType>(encoded[position]) == type) count++;
+
+        size_t payload_size = 0;
+        for (size_t i = 0; i < sizeof(size_t); i++)
+            payload_size |= static_cast<size_t>(encoded[position + 1 + sizeof(size_t) + i]) << (8 * i);
+        position += BLOCK_HEADER_SIZE + payload_size;
+    }
+
+    return count;
+}
+
+//overwrites the number of characters in the header of the block at the given position.
+void set_raw_size(std::vector<byte>& encoded, size_t position, size_t raw_size) {
+    for (size_t i = 0; i < sizeof(size_t); i++)
+        encoded[position + 1 + i] = static_cast<byte>(raw_size >> (8 * i));
+}
+
+//overwrites the payload size in the header of the block at the given position.
+void set_payload_size(std::vector<byte>& encoded, size_t position, size_t payload_size) {
+    for (size_t i = 0; i < sizeof(size_t); i++)
+        encoded[position + 1 + sizeof(size_t) + i] = static_cast<byte>(payload_size >> (8 * i));
+}
+
+//both decoders must reject the given blocks.
+bool decode_fails(const std::vector<byte>& encoded) {
+    size_t failures = 0;
+    try {
+        decoder::decode_blocks(encoded);
+    } catch (const std::runtime_error&) {
+        failures++;
+    }
+
+    auto input = std::istringstream(std::string(encoded.begin(), encoded.end()));
+    auto output = std::ostringstream();
+    try {
+        decoder::decode_blocks(input, output);
+    } catch (const std::runtime_error&) {
+        failures++;
+    }
+
+    return failures == 2;
+}
+
+void testBlocksRoundTrip() {
+    //one compressible block between two random ones
+    auto sentence = std::string("this is an example of a huffman tree. ");
+    auto repeated = std::string();
+    while (repeated.size() < 3000)
+        repeated += sentence;
+    auto text = random_text(3000, 1) + repeated.substr(0, 3000) + random_text(2500, 2);
+
+    for (size_t workers : {1, 4}) {
+        auto encoded = encoder::encode_blocks(text, workers, 3000);
+        auto decoded = decoder::decode_blocks(encoded);
+        assert(decoded == text, "Block round trip failed with ", workers, " workers.");
+
+        assert(count_blocks(encoded, blockType::stored) == 2, "Expected the two random blocks to be stored.");
+        assert(count_blocks(encoded, blockType::huffman) == 1, "Expected the repeated block to be coded.");
+    }
+
+    auto empty = encoder::encode_blocks("");
+    assert(decoder::decode_blocks(empty).empty(), "Expected an empty text.");
+}
+
+void testMinimumSaving() {
+    //about half of the bits are saved, so the block is coded up to a 50% threshold only
+    std::string text;
+    for (size_t i = 0; i < 4000; i++)
+        text.push_back(static_cast<char>(i % 16));
+
+    auto coded = encoder::encode_blocks(text, 1, 4000, 40);
+    auto stored = encoder::encode_blocks(text, 1, 4000, 60);
+    assert(count_blocks(coded, blockType::packed) == 1, "Expected the block to be packed with a 40% threshold.");
+    assert(count_blocks(stored, blockType::stored) == 1, "Expected the block to be stored with a 60% threshold.");
+    assert(decoder::decode_blocks(stored) == text, "Stored block round trip failed.");
+}
+
+void testDegenerateAlphabets() {
+    //a zero filled block, then blocks of 2, 4 and 16 evenly used characters
+    auto text = std::string(4000, '\0');
+    for (size_t characters : {2, 4, 16}) {
+        for (size_t i = 0; i < 4000; i++)
+            text.push_back(static_cast<char>('a' + (i * 7) % characters));
+    }
+
+    auto encoded = encoder::encode_blocks(text, 1, 4000);
+    assert(decoder::decode_blocks(encoded) == text, "Degenerate alphabet round trip failed.");
+    assert(count_blocks(encoded, blockType::constant) == 1, "Expected one constant block.");
+    assert(count_blocks(encoded, blockType::packed) == 3, "Expected the small alphabets to be packed.");
+
+    //the last block is partial
+    encoded = encoder::encode_blocks(text.substr(0, text.size() - 5), 1, 4000);
+    assert(decoder::decode_blocks(encoded) == text.substr(0, text.size() - 5), "Partial packed block round trip failed.");
+}
+
+void testSkewedSmallAlphabetIsCoded() {
+    //huffman beats 2 bits per character when one of the four characters dominates
+    std::string text;
+    for (size_t i = 0; i < 4000; i++)
+        text.push_back((i % 16 < 13) ? 'a' : static_cast<char>('b' + i % 3));
+
+    auto encoded = encoder::encode_blocks(text, 1, 4000);
+    assert(count_blocks(encoded, blockType::huffman) == 1, "Expected the skewed block to be huffman coded.");
+    assert(decoder::decode_blocks(encoded) == text, "Skewed block round trip failed.");
+}
+
+void testRepeatPreviousTable() {
+    //neighbouring blocks of similar log lines share their table
+    std::string text;
+    for (size_t i = 0; text.size() < 64 * 1024; i++)
+        text += "2024-05-01 INFO request " + std::to_string(i * 7919 % 10007) + " served in " + std::to_string(i % 97) + "ms\n";
+
+    for (size_t workers : {1, 4}) {
+        auto encoded = encoder::encode_blocks(text, workers, 1024);
+        assert(decoder::decode_blocks(encoded) == text, "Repeat block round trip failed with ", workers, " workers.");
+
+        auto blocks = positive_div_ceil<size_t>(text.size(), 1024);
+        auto repeats = count_blocks(encoded, blockType::repeat);
+        assert(repeats + workers >= blocks * 3 / 4, "Expected most blocks to repeat the previous table, found ",
+            repeats, " out of ", blocks);
+        assert(count_blocks(encoded, blockType::huffman) >= workers, "Expected each worker to start with its own table.");
+    }
+}
+
+void testPipelinedEncoder() {
+    std::string text;
+    for (size_t i = 0; text.size() < 200 * 1024; i++)
+        text += "2024-05-01 INFO request " + std::to_string(i * 7919 % 10007) + " served in " + std::to_string(i % 97) + "ms\n";
+    text += random_text(5000, 3);
+
+    for (size_t workers : {1, 3}) {
+        auto input = std::istringstream(text);
+        auto output = std::ostringstream();
+        encoder::encode_blocks(input, output, workers, 1024);
+
+        auto encoded_string = output.str();
+        auto encoded = std::vector<byte>(encoded_string.begin(), encoded_string.end());
+        assert(decoder::decode_blocks(encoded) == text, "Pipelined round trip failed with ", workers, " workers.");
+
+        auto encoded_input = std::istringstream(encoded_string);
+        auto decoded_output = std::ostringstream();
+        decoder::decode_blocks(encoded_input, decoded_output);
+        assert(decoded_output.str() == text, "Streaming decoder failed with ", workers, " workers.");
+        assert(count_blocks(encoded, blockType::repeat) > count_blocks(encoded, blockType::huffman),
+            "Expected most log blocks to repeat a table with ", workers, " workers.");
+    }
+
+    auto input = std::istringstream("");
+    auto output = std::ostringstream();
+    encoder::encode_blocks(input, output);
+    auto empty = output.str();
+    assert(decoder::decode_blocks(std::vector<byte>(empty.begin(), empty.end())).empty(), "Expected an empty text.");
+}
+
+void testFastFlowPipeline() {
+    auto text = random_text(3000, 4);
+    for (size_t i = 0; text.size() < 100 * 1024; i++)
+        text += "2024-05-01 INFO request " + std::to_string(i * 7919 % 10007) + " served in " + std::to_string(i % 97) + "ms\n";
+
+    for (size_t workers : {1, 3}) {
+        auto input = std::istringstream(text);
+        auto output = std::ostringstream();
+        encoder::encode_blocks_ff(input, output, workers, 1000);
+
+        auto encoded_string = output.str();
+        auto encoded = std::vector<byte>(encoded_string.begin(), encoded_string.end());
+        assert(decoder::decode_blocks(encoded) == text, "FastFlow pipeline round trip failed with ", workers, " workers.");
+        assert(count_blocks(encoded, blockType::stored) == 3, "Expected the three random blocks to be stored.");
+    }
+}
+
+//a stream buffer which serves size bytes of text, or accepts size bytes of output, then fails.
+struct failingBuffer : std::streambuf {
+    std::string text;
+    size_t size;
+
+    failingBuffer(size_t size) : text(size, 'a'), size(size) {
+        setg(text.data(), text.data(), text.data() + size);
+    }
+
+    int_type underflow() override {
+        throw std::runtime_error("read failure");
+    }
+
+    int_type overflow(int_type) override {
+        throw std::runtime_error("write failure");
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override {
+        if (static_cast<size_t>(count) > size) throw std::runtime_error("write failure");
+        size -= count;
+        return count;
+    }
+};
+
+//a failing stage ends the whole pipeline with its exception.
+void testPipelineFailures() {
+    for (size_t workers : {1, 3}) {
+        for (bool reading : {true, false}) {
+            auto buffer = failingBuffer(reading ? 200 * 1024 : 10 * 1024);
+            auto text = std::istringstream(std::string(200 * 1024, 'a') + random_text(50000, 7));
+            auto failing = std::iostream(&buffer);
+            failing.exceptions(std::ios::badbit);
+
+            std::string message;
+            try {
+                if (reading) {
+                    auto output = std::ostringstream();
+                    encoder::encode_blocks(failing, output, workers, 1024);
+                } else {
+                    encoder::encode_blocks(text, failing, workers, 1024);
+                }
+            } catch (const std::exception& e) {
+                message = e.what();
+            }
+
+            auto expected = reading ? "read failure" : "write failure";
+            assert(message == expected, "Expected a ", expected, " with ", workers, " workers, found '", message, "'");
+        }
+    }
+}
+
+void testCorruptStoredBlock() {
+    auto encoded = encoder::encode_blocks(random_text(3000, 5), 1, 3000);
+    assert(count_blocks(encoded, blockType::stored) == 1, "Expected the random block to be stored.");
+
+    for (size_t raw_size : {size_t(2999), size_t(3001), size_t(1) << 40}) {
+        set_raw_size(encoded, 0, raw_size);
+        assert(decode_fails(encoded), "Expected a stored block of ", raw_size, " characters to be rejected.");
+    }
+}
+
+void testCorruptConstantBlock() {
+    //a constant block of 5 characters without its character, then the end block
+    for (size_t payload_size : {0, 2}) {
+        auto encoded = std::vector<byte>(2 * BLOCK_HEADER_SIZE + payload_size, 0);
+        encoded[0] = static_cast<byte>(blockType::constant);
+        set_raw_size(encoded, 0, 5);
+        set_payload_size(encoded, 0, payload_size);
+        assert(decode_fails(encoded), "Expected a constant block with a payload of ", payload_size, " bytes to be rejected.");
+    }
+}
+
+void testCorruptPackedBlock() {
+    std::string text;
+    for (size_t i = 0; i < 4000; i++)
+        text.push_back(static_cast<char>('a' + (i * 7) % 4));
+
+    auto encoded = encoder::encode_blocks(text, 1, 4000);
+    assert(count_blocks(encoded, blockType::packed) == 1, "Expected the block to be packed.");
+
+    //the 1000 payload bytes after the alphabet hold 4000 characters, not one more
+    for (size_t raw_size : {size_t(4001), size_t(1) << 40, ~size_t(0)}) {
+        set_raw_size(encoded, 0, raw_size);
+        assert(decode_fails(encoded), "Expected a packed block of ", raw_size, " characters to be rejected.");
+    }
+}
+
+//sizes from a corrupt header must fail instead of being allocated.
+void testCorruptBlockSizes() {
+    auto stored = encoder::encode_blocks(random_text(3000, 6), 1, 3000);
+    for (size_t payload_size : {size_t(1) << 40, ~size_t(0)}) {
+        auto encoded = stored;
+        set_raw_size(encoded, 0, payload_size);
+        set_payload_size(encoded, 0, payload_size);
+        assert(decode_fails(encoded), "Expected a payload of ", payload_size, " bytes to be rejected.");
+    }
+
+    std::string text;
+    for (size_t i = 0; text.size() < 4000; i++)
+        text += "2024-05-01 INFO request " + std::to_string(i * 7919 % 10007) + " served in " + std::to_string(i % 97) + "ms\n";
+
+    auto coded = encoder::encode_blocks(text, 1, text.size());
+    assert(count_blocks(coded, blockType::huffman) == 1, "Expected the log block to be huffman coded.");
+    set_raw_size(coded, 0, size_t(1) << 40);
+    assert(decode_fails(coded), "Expected a coded block of more characters than payload bits to be rejected.");
+}
+
+void testMain()
+{
+    testBlocksRoundTrip();
+    testMinimumSaving();
+    testDegenerateAlphabets();
+    testSkewedSmallAlphabetIsCoded();
+    testRepeatPreviousTable();
+    testPipelinedEncoder();
+    testFastFlowPipeline();
+    testPipelineFailures();
+    testCorruptStoredBlock();
+    testCorruptConstantBlock();
+    testCorruptPackedBlock();
+    testCorruptBlockSizes();
+}
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "decoder_context.h"
+
+#include <algorithm>
+
+#include "../utils.h"
+
+namespace huffman::decoder::detail
+{
+    size_t read_text_metadata(std::vector<byte>::const_iterator&);
+
+    void decode_text(const decoderTree&, const std::vector<byte>&, std::vector<byte>::const_iterator, size_t, std::string&);
+
+    //returns the end of the serialized table which starts at the given iterator.
+    std::vector<byte>::const_iterator serialized_table_end(
+        std::vector<byte>::const_iterator iter,
+        std::vector<byte>::const_iterator end
+    ) {
+        if (std::distance(iter, end) < 2) return end;
+
+        auto number_of_characters = read_number_of_characters(iter);
+        for (size_t i = 0; i < number_of_characters && std::distance(iter, end) >= 2; i++) {
+            iter++; //character
+            auto bits = *iter; iter++;
+            auto bytes = positive_div_ceil<size_t>(bits, 8);
+            iter += std::min<size_t>(bytes, std::distance(iter, end));
+        }
+
+        return iter;
+    }
+}
+
+namespace huffman::decoder
+{
+    void decoderContext::decode(const std::vector<byte>& encoded_text, std::string& out_text) {
+        out_text.clear();
+
+        auto iter = encoded_text.cbegin();
+        auto table_end = detail::serialized_table_end(iter, encoded_text.cend());
+
+        //rebuild the decoding tree only if the table is different from the last one
+        if (!tree || !std::equal(iter, table_end, serialized_table.cbegin(), serialized_table.cend())) {
+            serialized_table.assign(iter, table_end);
+            tree.emplace(iter);
+        }
+        iter = table_end;
+
+        auto number_of_characters = detail::read_text_metadata(iter);
+        detail::decode_text(*tree, encoded_text, iter, number_of_characters, out_text);
+    }
+
+    std::string decoderContext::decode(const std::vector<byte>& encoded_text) {
+        auto out_text = std::string();
+        decode(encoded_text, out_text);
+        return out_text;
+    }
+}
@@ -0,0 +1,30 @@
+#ifndef HUFFMAN_DECODER_CONTEXT
+#define HUFFMAN_DECODER_CONTEXT
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "../definitions.h"
+#include "decoder_tree.h"
+
+namespace huffman::decoder
+{
+    //a decoderContext keeps the decoding tree of the last input and the capacity of
+    //the output string between calls: inputs encoded with the same table (as it is common
+    //for similar payloads) skip the tree construction.
+    class decoderContext {
+    private:
+        std::vector<byte> serialized_table;
+        std::optional<decoderTree> tree;
+
+    public:
+        decoderContext() = default;
+
+        //the output string is cleared, its capacity is reused.
+        void decode(const std::vector<byte>& encoded_text, std::string& out_text);
+        std::string decode(const std::vector<byte>& encoded_text);
+    };
+}
+
+#endif
@@ -0,0 +1,86 @@
+#include "decoder.h"
+
+#include <array>
+
+#include "decoder_lookup.h"
+#include "../utils.h"
+
+namespace huffman::decoder::detail
+{
+    size_t read_text_metadata(std::vector<byte>::const_iterator&);
+
+    //the first sub-stream starts right after the offsets of the other ones.
+    std::array<size_t, INTERLEAVED_STREAMS> read_stream_offsets(
+        const std::vector<byte>& encoded_text,
+        std::vector<byte>::const_iterator& iter
+    ) {
+        auto offsets = std::array<size_t, INTERLEAVED_STREAMS>();
+        for (size_t i = 1; i < INTERLEAVED_STREAMS; i++)
+            offsets[i] = read_text_metadata(iter);
+
+        auto data_start = static_cast<size_t>(std::distance(encoded_text.cbegin(), iter));
+        offsets[0] = data_start;
+        for (size_t i = 1; i < INTERLEAVED_STREAMS; i++) {
+            offsets[i] += data_start;
+            if (offsets[i] < offsets[i - 1] || offsets[i] > encoded_text.size())
+                throw std::runtime_error("Invalid sub-stream offsets in the interleaved header.");
+        }
+
+        return offsets;
+    }
+
+    //the sub-streams are independent, so the table lookups of one group of characters
+    //do not wait on each other and can be overlapped by the CPU. a pointer tree would
+    //serialize every bit of a code behind the previous one instead.
+    void decode_text_interleaved(
+        const decoderLookup& decoder,
+        const std::vector<byte>& encoded_text,
+        std::array<size_t, INTERLEAVED_STREAMS> const& offsets,
+        size_t number_of_characters,
+        std::string& out_text
+    ) {
+        auto s0 = lookupReader(encoded_text, offsets[0]);
+        auto s1 = lookupReader(encoded_text, offsets[1]);
+        auto s2 = lookupReader(encoded_text, offsets[2]);
+        auto s3 = lookupReader(encoded_text, offsets[3]);
+        auto streams = std::array<lookupReader*, INTERLEAVED_STREAMS>{ &s0, &s1, &s2, &s3 };
+
+        auto start = out_text.size();
+        out_text.resize(start + number_of_characters);
+        auto out = out_text.begin() + start;
+
+        size_t i = 0;
+        for (; i + INTERLEAVED_STREAMS <= number_of_characters; i += INTERLEAVED_STREAMS) {
+            out[i] = decoder.decode(s0);
+            out[i + 1] = decoder.decode(s1);
+            out[i + 2] = decoder.decode(s2);
+            out[i + 3] = decoder.decode(s3);
+        }
+
+        for (; i < number_of_characters; i++)
+            out[i] = decoder.decode(*streams[i % INTERLEAVED_STREAMS]);
+    }
+}
+
+namespace huffman::decoder
+{
+    std::string decode_interleaved(const std::vector<byte>& encoded_text)
+    {
+        static_assert(INTERLEAVED_STREAMS == 4, "decode_text_interleaved is unrolled for 4 sub-streams");
+
+        auto iter = encoded_text.cbegin();
+
+        //decode encodings
+        auto decoder = decoderLookup(iter);
+
+        //get the number of characters and where each sub-stream starts
+        auto number_of_characters = detail::read_text_metadata(iter);
+        auto offsets = detail::read_stream_offsets(encoded_text, iter);
+
+        //decode characters
+        auto string = std::string();
+        detail::decode_text_interleaved(decoder, encoded_text, offsets, number_of_characters, string);
+
+        return string;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "decoder.h"
+
+#include "../test_utils.h"
+
+#include "../encoder/encoder.h"
+
+using namespace huffman;
+
+void assertInterleavedRoundTrip(const std::string& text) {
+    auto encoded = encoder::encode_interleaved(text);
+    auto decoded = decoder::decode_interleaved(encoded);
+    assert(decoded == text, "Interleaved round trip failed for a text of ", text.size(), " characters.");
+}
+
+void testInterleavedRoundTrip() {
+    assertInterleavedRoundTrip("");
+    assertInterleavedRoundTrip("ab");
+    assertInterleavedRoundTrip("this is an example of a huffman tree");
+
+    //every remainder of the round robin split
+    std::string text;
+    for (size_t i = 0; i < 4099; i++) {
+        text.push_back(static_cast<char>((i * 7 + i / 13) % 37));
+        if (i >= 4095) assertInterleavedRoundTrip(text);
+    }
+}
+
+void testLongCodes() {
+    //fibonacci frequencies give codes of up to 29 bits, decoded through two levels of sub-tables
+    std::string text;
+    size_t previous = 1, current = 1;
+    for (char character = 'a'; character < 'a' + 30; character++) {
+        text += std::string(current, character);
+        auto next = previous + current;
+        previous = current;
+        current = next;
+    }
+    for (size_t i = 0; i < text.size(); i += 2)
+        std::swap(text[i], text[(i * 7919) % text.size()]);
+
+    assertInterleavedRoundTrip(text);
+    assertInterleavedRoundTrip(std::string(1000, 'z'));
+}
+
+void testInterleavedSize() {
+    //the sub-streams only add their offsets and up to one byte of padding each
+    std::string text;
+    for (size_t i = 0; i < 10000; i++)
+        text.push_back(static_cast<char>(i % 11));
+
+    auto plain = encoder::encode(text);
+    auto interleaved = encoder::encode_interleaved(text);
+    auto overhead = (INTERLEAVED_STREAMS - 1) * (sizeof(size_t) + 1);
+    assert(interleaved.size() <= plain.size() + overhead,
+        "Expected at most ", plain.size() + overhead, " bytes but found ", interleaved.size());
+}
+
+void testMain()
+{
+    testInterleavedRoundTrip();
+    testLongCodes();
+    testInterleavedSize();
+}
\ No newline at end of file
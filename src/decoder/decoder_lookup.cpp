@@ -0,0 +1,73 @@
+#include "decoder_lookup.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "decoder_tree.h"
+#include "../encoder/serializable_character.h"
+
+namespace huffman::decoder
+{
+    using namespace huffman::encoder;
+
+    lookupReader::lookupReader(const std::vector<byte>& data, size_t byte_offset)
+        : next(data.data() + std::min(byte_offset, data.size())), end(data.data() + data.size()), buffer(0), buffered_bits(0) {}
+
+    //the bit patterns no code starts with decode to '\0' without consuming any bit,
+    //as the tree decoder does once the data is over.
+    decoderLookup::decoderLookup(std::vector<byte>::const_iterator& encoded_table)
+        : entries(1 << LOOKUP_BITS, lookupEntry{ 0, 0, true })
+    {
+        auto number_of_characters = read_number_of_characters(encoded_table);
+        for (size_t i = 0; i < number_of_characters; i++) {
+            auto character = serializableCharacter(encoded_table);
+
+            auto code = std::vector<bool>(character.encoding.bits);
+            for (size_t bit = 0; bit < code.size(); bit++)
+                code[bit] = character.encoding.get_bit(bit + 1);
+
+            insert(static_cast<byte>(character.character), code);
+        }
+    }
+
+    decoderLookup::decoderLookup(std::vector<byte>::const_iterator&& encoded_table)
+        : decoderLookup(encoded_table) { }
+
+    void decoderLookup::insert(byte character, const std::vector<bool>& code) {
+        size_t table = 0;
+        size_t position = 0;
+
+        //walk down the sub-tables while the code is longer than a lookup
+        while (code.size() - position > LOOKUP_BITS) {
+            uint32_t index = 0;
+            for (size_t bit = 0; bit < LOOKUP_BITS; bit++)
+                index = (index << 1) | code[position + bit];
+            position += LOOKUP_BITS;
+
+            auto& entry = entries[table + index];
+            if (entry.leaf && entry.bits > 0)
+                throw std::runtime_error("Given character codes are not prefix free codes.");
+
+            if (entry.leaf) {
+                entry = lookupEntry{ static_cast<uint32_t>(entries.size()), 0, false };
+                entries.resize(entries.size() + (1 << LOOKUP_BITS), lookupEntry{ 0, 0, true });
+            }
+            table = entries[table + index].value;
+        }
+
+        //the code fills every entry it is a prefix of
+        auto bits = code.size() - position;
+        uint32_t prefix = 0;
+        for (size_t bit = 0; bit < bits; bit++)
+            prefix = (prefix << 1) | code[position + bit];
+
+        auto first = table + (prefix << (LOOKUP_BITS - bits));
+        auto last = first + (size_t(1) << (LOOKUP_BITS - bits));
+        for (auto i = first; i < last; i++) {
+            if (!entries[i].leaf || entries[i].bits > 0)
+                throw std::runtime_error("Given character codes are not prefix free codes.");
+
+            entries[i] = lookupEntry{ character, static_cast<byte>(bits), true };
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,76 @@
+#ifndef HUFFMAN_DECODER_LOOKUP
+#define HUFFMAN_DECODER_LOOKUP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "../definitions.h"
+
+namespace huffman::decoder
+{
+    //number of bits decoded by a single lookup: codes up to this length take one lookup,
+    //longer ones continue into a sub-table for each further LOOKUP_BITS bits.
+    constexpr size_t LOOKUP_BITS = 11;
+
+    //reads the bits of an encoded text, most significant first, LOOKUP_BITS at a time.
+    //the bits past the end of the data read as zeros.
+    struct lookupReader {
+    private:
+        const byte* next;
+        const byte* end;
+        uint64_t buffer;
+        size_t buffered_bits;
+
+    public:
+        lookupReader(const std::vector<byte>& data, size_t byte_offset);
+
+        inline uint32_t peek() {
+            while (buffered_bits <= 56) {
+                uint64_t value = (next < end) ? *next++ : 0;
+                buffer |= value << (56 - buffered_bits);
+                buffered_bits += 8;
+            }
+
+            return static_cast<uint32_t>(buffer >> (64 - LOOKUP_BITS));
+        }
+
+        inline void consume(size_t bits) {
+            buffer <<= bits;
+            buffered_bits -= bits;
+        }
+    };
+
+    //a table driven decoder: the next LOOKUP_BITS bits index an entry which is either the
+    //character of the code they start with (and its length), or the sub-table of the longer
+    //codes sharing those bits as a prefix.
+    class decoderLookup {
+    private:
+        struct lookupEntry {
+            uint32_t value;
+            byte bits;
+            bool leaf;
+        };
+
+        std::vector<lookupEntry> entries;
+
+        void insert(byte character, const std::vector<bool>& code);
+
+    public:
+        decoderLookup(std::vector<byte>::const_iterator& encoded_table);
+        decoderLookup(std::vector<byte>::const_iterator&& encoded_table);
+
+        inline char decode(lookupReader& reader) const {
+            auto entry = entries[reader.peek()];
+            while (!entry.leaf) {
+                reader.consume(LOOKUP_BITS);
+                entry = entries[entry.value + reader.peek()];
+            }
+
+            reader.consume(entry.bits);
+            return static_cast<char>(entry.value);
+        }
+    };
+}
+
+#endif
\ No newline at end of file
@@ -64,8 +64,20 @@ namespace huffman::decoder
         return trueChild == nullptr && falseChild == nullptr;
     }
 
+    //the count takes two bytes (little endian), see encoderTable::serialize
+    size_t read_number_of_characters(std::vector<byte>::const_iterator& encoded_table) {
+        size_t number_of_characters = encoded_table[0] | (encoded_table[1] << 8);
+        encoded_table += 2;
+
+        if (number_of_characters > TABLE_SIZE)
+            throw std::runtime_error("Serialized table has more than " + std::to_string(TABLE_SIZE) + " characters.");
+
+        return number_of_characters;
+    }
+
     decoderTree::decoderTree(std::vector<byte>::const_iterator& encoded_table) : root('\0') {
-        auto number_of_characters = *encoded_table; encoded_table++;
+        auto number_of_characters = read_number_of_characters(encoded_table);
+        if (number_of_characters == 0) return;
 
         auto characters = std::vector<serializableCharacter>();
         characters.reserve(number_of_characters);
@@ -20,6 +20,9 @@ namespace huffman::decoder
         bool is_leaf() const;
     };
 
+    //reads the number of characters of a serialized table, advancing the iterator.
+    size_t read_number_of_characters(std::vector<byte>::const_iterator& encoded_table);
+
     class decoderTree {
     private:
         decoderNode root;
@@ -11,7 +11,7 @@ void testBuildDecoderTree() {
     using namespace huffman::encoder;
 
     //frequencies for the string: this is an example of a huffman tree
-    auto frequencies = std::unordered_map<char, int>{
+    auto frequencies = frequencyMap{
         {' ', 7}, {'a', 4}, {'e', 4}, {'f', 3}, {'h', 2}, {'i', 2}, {'m', 2}, {'n', 2},
         {'s', 2}, {'t', 2}, {'l', 1}, {'o', 1}, {'p', 1}, {'r', 1}, {'u', 1}, {'x', 1},
     };
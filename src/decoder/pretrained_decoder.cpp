@@ -0,0 +1,40 @@
+#include "pretrained_decoder.h"
+
+#include "../utils.h"
+
+namespace huffman::decoder::detail
+{
+    size_t read_text_metadata(std::vector<byte>::const_iterator&);
+
+    void decode_text(const decoderTree&, const std::vector<byte>&, std::vector<byte>::const_iterator, size_t, std::string&);
+}
+
+namespace huffman::decoder
+{
+    pretrainedDecoder::pretrainedDecoder(const std::vector<byte>& serialized_table)
+        : tree(serialized_table.cbegin()), id(fnv1a_hash(serialized_table.cbegin(), serialized_table.cend())) {}
+
+    void pretrainedDecoder::decode(const std::vector<byte>& encoded_text, std::string& out_text) const {
+        if (encoded_text.size() < sizeof(uint64_t) + sizeof(size_t))
+            throw std::runtime_error("Encoded text is too short to hold its table id.");
+
+        uint64_t encoded_id = 0;
+        auto iter = encoded_text.cbegin();
+        auto id_bytes = reinterpret_cast<byte*>(&encoded_id);
+        for (size_t i = 0; i < sizeof(uint64_t); i++) {
+            id_bytes[i] = *iter; iter++;
+        }
+
+        if (encoded_id != id)
+            throw std::runtime_error("The text was encoded with a different table.");
+
+        auto number_of_characters = detail::read_text_metadata(iter);
+        detail::decode_text(tree, encoded_text, iter, number_of_characters, out_text);
+    }
+
+    std::string pretrainedDecoder::decode(const std::vector<byte>& encoded_text) const {
+        auto out_text = std::string();
+        decode(encoded_text, out_text);
+        return out_text;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#ifndef HUFFMAN_PRETRAINED_DECODER
+#define HUFFMAN_PRETRAINED_DECODER
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../definitions.h"
+#include "decoder_tree.h"
+
+namespace huffman::decoder
+{
+    //a pretrainedDecoder builds the decoding tree of a shared table once,
+    //and decodes the texts encoded by a pretrainedEncoder with the same table.
+    class pretrainedDecoder {
+    private:
+        decoderTree tree;
+        uint64_t id;
+
+    public:
+        pretrainedDecoder(const std::vector<byte>& serialized_table);
+
+        inline uint64_t get_id() const {
+            return id;
+        }
+
+        //throws if the text was encoded with a different table.
+        void decode(const std::vector<byte>& encoded_text, std::string& out_text) const;
+        std::string decode(const std::vector<byte>& encoded_text) const;
+    };
+}
+
+#endif
\ No newline at end of file
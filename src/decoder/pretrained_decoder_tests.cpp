@@ -0,0 +1,63 @@
+#include "pretrained_decoder.h"
+
+#include "../test_utils.h"
+
+#include "../encoder/pretrained_encoder.h"
+
+using namespace huffman;
+
+void testSerializedTableRoundTrip() {
+    auto table = encoder::train_table("{\"level\": \"info\", \"message\": \"started\"}");
+    auto serialized = table.serialize();
+
+    auto iter = serialized.cbegin();
+    auto deserialized = encoder::encoderTable(iter, serialized.cend());
+    assert(iter == serialized.cend(), "Expected the whole table to be read.");
+
+    for (size_t i = 0; i < TABLE_SIZE; i++) {
+        assert(table.get(i) == deserialized.get(i), "Character ", i, " changed code: ",
+            table.get(i).to_string(), " became ", deserialized.get(i).to_string());
+    }
+}
+
+void testPretrainedRoundTrip() {
+    auto corpus = std::string();
+    for (size_t i = 0; i < 100; i++)
+        corpus += "{\"level\": \"info\", \"id\": " + std::to_string(i) + ", \"message\": \"request served\"}\n";
+
+    //the table is shipped as its serialization, as with --table
+    auto serialized = encoder::train_table(corpus).serialize();
+    auto encoder = encoder::pretrainedEncoder(serialized);
+    auto decoder = decoder::pretrainedDecoder(serialized);
+    assert(encoder.get_id() == decoder.get_id(), "Encoder and decoder disagree on the table id.");
+
+    //the last payload has characters which are not in the corpus
+    for (auto payload : {std::string(), std::string("{\"level\": \"info\", \"id\": 7}"), std::string("ZZZ \x01\xff")}) {
+        auto encoded = encoder.encode(payload);
+        assert(decoder.decode(encoded) == payload, "Pretrained round trip failed for \"", payload, "\"");
+    }
+
+    //the payload header is much smaller than a table
+    auto encoded = encoder.encode("{\"level\": \"info\"}");
+    assert(encoded.size() < 32, "Expected a header without the table, found ", encoded.size(), " bytes.");
+}
+
+void testTableMismatch() {
+    auto encoder = encoder::pretrainedEncoder(encoder::train_table("aaaaab"));
+    auto decoder = decoder::pretrainedDecoder(encoder::train_table("bbbbba").serialize());
+
+    bool thrown = false;
+    try {
+        decoder.decode(encoder.encode("abba"));
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown, "Expected decoding with a different table to fail.");
+}
+
+void testMain()
+{
+    testSerializedTableRoundTrip();
+    testPretrainedRoundTrip();
+    testTableMismatch();
+}
\ No newline at end of file
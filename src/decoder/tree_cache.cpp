@@ -0,0 +1,96 @@
+#include "tree_cache.h"
+
+#include <algorithm>
+
+#include "../utils.h"
+
+namespace huffman::decoder::detail
+{
+    size_t read_text_metadata(std::vector<byte>::const_iterator&);
+
+    void decode_text(const decoderTree&, const std::vector<byte>&, std::vector<byte>::const_iterator, size_t, std::string&);
+
+    std::vector<byte>::const_iterator serialized_table_end(std::vector<byte>::const_iterator, std::vector<byte>::const_iterator);
+}
+
+namespace huffman::decoder
+{
+    treeCache::treeCache(size_t capacity)
+        : capacity(capacity == 0 ? 1 : capacity), hits(0), misses(0) {}
+
+    treeCache& treeCache::instance() {
+        static treeCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const decoderTree> treeCache::get(
+        std::vector<byte>::const_iterator table_start,
+        std::vector<byte>::const_iterator table_end
+    ) {
+        auto hash = fnv1a_hash(table_start, table_end);
+
+        {
+            auto lock = std::lock_guard(mutex);
+            auto found = index.find(hash);
+
+            //the bytes are compared as well, so that a hash collision is just a miss
+            if (found != index.end() && std::equal(table_start, table_end, found->second->serialized.cbegin(), found->second->serialized.cend())) {
+                //move to the front, as the most recently used
+                entries.splice(entries.begin(), entries, found->second);
+                hits++;
+                return entries.front().tree;
+            }
+            misses++;
+        }
+
+        //build the tree outside of the lock
+        auto tree = std::make_shared<const decoderTree>(std::vector<byte>::const_iterator(table_start));
+
+        auto lock = std::lock_guard(mutex);
+        auto found = index.find(hash);
+        if (found != index.end()) {
+            entries.erase(found->second);
+            index.erase(found);
+        }
+
+        entries.push_front(cachedTree{hash, std::vector<byte>(table_start, table_end), tree});
+        index[hash] = entries.begin();
+        if (entries.size() > capacity) {
+            index.erase(entries.back().hash);
+            entries.pop_back();
+        }
+
+        return tree;
+    }
+
+    size_t treeCache::get_hits() {
+        auto lock = std::lock_guard(mutex);
+        return hits;
+    }
+
+    size_t treeCache::get_misses() {
+        auto lock = std::lock_guard(mutex);
+        return misses;
+    }
+
+    void treeCache::clear() {
+        auto lock = std::lock_guard(mutex);
+        entries.clear();
+        index.clear();
+        hits = 0;
+        misses = 0;
+    }
+
+    std::string decode_cached(const std::vector<byte>& encoded_text, treeCache& cache) {
+        auto iter = encoded_text.cbegin();
+        auto table_end = detail::serialized_table_end(iter, encoded_text.cend());
+        auto tree = cache.get(iter, table_end);
+        iter = table_end;
+
+        auto number_of_characters = detail::read_text_metadata(iter);
+        auto string = std::string();
+        detail::decode_text(*tree, encoded_text, iter, number_of_characters, string);
+
+        return string;
+    }
+}
\ No newline at end of file
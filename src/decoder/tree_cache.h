@@ -0,0 +1,52 @@
+#ifndef HUFFMAN_TREE_CACHE
+#define HUFFMAN_TREE_CACHE
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../definitions.h"
+#include "decoder_tree.h"
+
+namespace huffman::decoder
+{
+    //a bounded, least recently used, cache of decoding trees, looked up by the hash of the
+    //serialized table in the header: texts encoded with a table seen before skip the tree construction.
+    class treeCache {
+    private:
+        struct cachedTree {
+            uint64_t hash;
+            std::vector<byte> serialized;
+            std::shared_ptr<const decoderTree> tree;
+        };
+
+        std::mutex mutex;
+        std::list<cachedTree> entries;
+        std::unordered_map<uint64_t, std::list<cachedTree>::iterator> index;
+        size_t capacity;
+        size_t hits;
+        size_t misses;
+
+    public:
+        treeCache(size_t capacity = DEFAULT_TABLE_CACHE_SIZE);
+        treeCache(const treeCache&) = delete;
+        treeCache& operator=(const treeCache&) = delete;
+
+        //process-wide cache, shared by all the threads.
+        static treeCache& instance();
+
+        std::shared_ptr<const decoderTree> get(std::vector<byte>::const_iterator table_start, std::vector<byte>::const_iterator table_end);
+
+        size_t get_hits();
+        size_t get_misses();
+        void clear();
+    };
+
+    std::string decode_cached(const std::vector<byte>& encoded_text, treeCache& cache = treeCache::instance());
+}
+
+#endif
\ No newline at end of file
@@ -4,6 +4,40 @@
 #define TABLE_SIZE 256
 #define TABLE_SIZE_BYTES 32
 
+//number of input bytes encoded by each iteration of the parallel for backend; every
+//iteration keeps its own 2 KB histogram, so smaller grains are rounded up to the minimum
+#define DEFAULT_GRAIN_SIZE 1048576
+#define MIN_GRAIN_SIZE 4096
+
+//number of input bytes of each block of the block format, and the minimum
+//percentage a block has to shrink by for it not to be stored as it is
+#define DEFAULT_BLOCK_SIZE 1048576
+#define DEFAULT_MIN_SAVING 5
+
+//number of tables kept by the process-wide table caches, and the extra size (as a
+//percentage of the entropy of the text) accepted when reusing a cached table
+#define DEFAULT_TABLE_CACHE_SIZE 16
+#define DEFAULT_TABLE_REUSE_PERCENT 5
+
+//number of round robin sub-streams of the interleaved format
+#define INTERLEAVED_STREAMS 4
+
+//size from which a file of a batch is coded by all the workers instead of a single one,
+//and extension of the files encoded by a batch
+#define DEFAULT_BATCH_LARGE_FILE 16777216
+#define BATCH_EXTENSION ".huf"
+
+//seconds the daemon waits for a client to send its job or to read its response, and
+//largest field (file name or inline input and output) of a job message
+#define DEFAULT_SERVICE_TIMEOUT 30
+#define MAX_SERVICE_FIELD_SIZE 1073741824
+
+//number of blocks of IO_BLOCK_SIZE bytes in flight in the io_uring of each thread, and
+//size from which the files are read with O_DIRECT when direct I/O is enabled
+#define IO_QUEUE_DEPTH 32
+#define IO_BLOCK_SIZE 1048576
+#define DEFAULT_DIRECT_IO_SIZE 1073741824
+
 typedef unsigned char byte;
 
 #endif
\ No newline at end of file
@@ -18,6 +18,11 @@ namespace huffman::encoder::detail
         characterSerializer(const encoderTable& table, std::vector<byte>& data, byte offset = 8);
 
         inline void append(char character);
+
+        //number of bits used in the last byte of the data.
+        inline byte last_byte_bits() const {
+            return last_bit;
+        }
     };
 
     void characterSerializer::append(char character) {
@@ -21,7 +21,7 @@ namespace huffman::encoder
         }
 
         code[ bytes() - 1 ] = curr_byte & leftByteMasks[last_byte_bits()];
-        curr_byte = *(++serialized);
+        ++serialized;
     }
     
     encodedCharacter::encodedCharacter(std::vector<byte>::const_iterator&& serialized)
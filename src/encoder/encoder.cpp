@@ -1,19 +1,19 @@
 #include "encoder.h"
 
+#include <algorithm>
+
 #include "encoder_table.h"
 #include "character_serializer.h"
 #include "../utils.h"
 
-#ifdef CHRONO_ENABLED
 #include "../timing.h"
-#endif
 
 namespace huffman::encoder::detail
 {
     using namespace huffman::encoder;
 
-    std::unordered_map<char, int> extract_frequencies(std::string::const_iterator text_start, std::string::const_iterator text_end) {
-        auto frequencies = std::unordered_map<char, int>();
+    frequencyMap extract_frequencies(std::string::const_iterator text_start, std::string::const_iterator text_end) {
+        auto frequencies = frequencyMap();
 
         for (auto iter = text_start; iter != text_end; iter++) {
             auto character = *iter;
@@ -27,6 +27,49 @@ namespace huffman::encoder::detail
         return frequencies;
     }
 
+    void extract_frequencies(
+        std::string::const_iterator text_start,
+        std::string::const_iterator text_end,
+        frequencyHistogram& frequencies
+    ) {
+        frequencies.fill(0);
+        for (auto iter = text_start; iter != text_end; iter++)
+            frequencies[static_cast<byte>(*iter)] += 1;
+    }
+
+    //the histogram is built from runs of SAMPLE_RUN_LENGTH characters (a cache line) taken at
+    //regular intervals, so that about sample_percent% of the text is read. characters which are
+    //never seen get a count of one, so that the resulting table can encode any text.
+    void extract_frequencies_sampled(
+        std::string::const_iterator text_start,
+        std::string::const_iterator text_end,
+        size_t sample_percent,
+        frequencyHistogram& frequencies
+    ) {
+        constexpr size_t SAMPLE_RUN_LENGTH = 64;
+
+        frequencies.fill(0);
+        auto length = static_cast<size_t>(text_end - text_start);
+        auto stride = SAMPLE_RUN_LENGTH * 100 / std::max<size_t>(sample_percent, 1);
+        for (size_t run = 0; run < length; run += stride) {
+            auto run_end = std::min(run + SAMPLE_RUN_LENGTH, length);
+            for (size_t i = run; i < run_end; i++)
+                frequencies[static_cast<byte>(text_start[i])] += 1;
+        }
+
+        for (auto& frequency : frequencies) {
+            if (frequency == 0) frequency = 1;
+        }
+    }
+
+    size_t count_bits(const encoderTable& table, const frequencyHistogram& frequencies) {
+        size_t bits = 0;
+        for (size_t i = 0; i < TABLE_SIZE; i++)
+            bits += table.get(i).bits * frequencies[i];
+
+        return bits;
+    }
+
     void append_text_metadata(
         std::string const& text,
         std::vector<byte>& out_data
@@ -38,44 +81,69 @@ namespace huffman::encoder::detail
         }
     }
 
-    std::vector<byte> encode_text(
+    void encode_text(
         const encoderTable& table,
         std::string::const_iterator text_start,
         std::string::const_iterator text_end,
-        byte offset
+        byte offset,
+        std::vector<byte>& out_data
     ) {
-        std::vector<byte> out_data;
         auto serializer = detail::characterSerializer(table, out_data, offset);
 
         for (auto iter = text_start; iter != text_end; iter++)
             serializer.append(*iter);
+    }
 
+    std::vector<byte> encode_text(
+        const encoderTable& table,
+        std::string::const_iterator text_start,
+        std::string::const_iterator text_end,
+        byte offset
+    ) {
+        std::vector<byte> out_data;
+        encode_text(table, text_start, text_end, offset, out_data);
         return out_data;
     };
+
+    //encodes the text starting from a byte boundary, returning the number of bits written.
+    size_t encode_text_aligned(
+        const encoderTable& table,
+        std::string::const_iterator text_start,
+        std::string::const_iterator text_end,
+        std::vector<byte>& out_data
+    ) {
+        auto serializer = detail::characterSerializer(table, out_data);
+
+        for (auto iter = text_start; iter != text_end; iter++)
+            serializer.append(*iter);
+
+        if (out_data.empty())
+            return 0;
+        else
+            return (out_data.size() - 1) * 8 + serializer.last_byte_bits();
+    }
 }
 
 namespace huffman::encoder
 {
-    std::vector<byte> encode(std::string text) {
-#ifdef CHRONO_ENABLED
-        auto& timing = TimingLogger::instance();
-        auto& frequencies_timer = timing.newTimer("02.00 - Extracting letter frequencies from the text.");
-#endif
-        //extract frequencies of letters
-        auto frequencies = detail::extract_frequencies(text.cbegin(), text.cend());
-
-#ifdef CHRONO_ENABLED
-        frequencies_timer.stopTimer();
-        auto& encodingTable_timer = timing.newTimer("02.01 - Building encoding table.");
-#endif
+    std::vector<byte> encode(std::string text, size_t sample_percent) {
+        auto frequencies_timer = TimingScope("frequencies");
+        //extract frequencies of letters, from the whole text or from a sample of it
+        auto frequencies = frequencyMap();
+        auto sampled_frequencies = frequencyHistogram();
+        if (sample_percent < 100)
+            detail::extract_frequencies_sampled(text.cbegin(), text.cend(), sample_percent, sampled_frequencies);
+        else
+            frequencies = detail::extract_frequencies(text.cbegin(), text.cend());
+
+        frequencies_timer.stop();
+        auto encodingTable_timer = TimingScope("table");
         
         //build the encoding table
-        auto table = encoderTable(frequencies);
+        auto table = (sample_percent < 100) ? encoderTable(sampled_frequencies) : encoderTable(frequencies);
 
-#ifdef CHRONO_ENABLED
-        encodingTable_timer.stopTimer();
-        auto& serialization_timer = timing.newTimer("02.02 - Serialization of text.");
-#endif
+        encodingTable_timer.stop();
+        auto serialization_timer = TimingScope("serialization");
 
         //serialize the table in the output array
         auto out_data = table.serialize();
@@ -87,9 +155,7 @@ namespace huffman::encoder
         auto serialized = detail::encode_text(table, text.begin(), text.end(), 0);
         out_data.insert(out_data.end(), serialized.begin(), serialized.end());
 
-#ifdef CHRONO_ENABLED
-        serialization_timer.stopTimer();
-#endif
+        serialization_timer.stop();
 
         return out_data;
     } 
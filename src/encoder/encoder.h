@@ -1,18 +1,69 @@
 #ifndef HUFFMAN_ENCODER
 #define HUFFMAN_ENCODER
 
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <istream>
+#include <ostream>
 
 #include "../definitions.h"
 
 namespace huffman::encoder
 {
-    std::vector<byte> encode(std::string text);
+    //with a sample_percent lower than 100 the table is built from a strided sample of the text
+    //instead of reading it all twice: the code may be slightly worse than the optimal one.
+    std::vector<byte> encode(std::string text, size_t sample_percent = 100);
 
-    std::vector<byte> encode_parallel_native(std::string text, size_t workers);
+    //character i is written to the sub-stream i % INTERLEAVED_STREAMS, each starting on a byte
+    //boundary recorded after the number of characters, so that they can be decoded side by side.
+    std::vector<byte> encode_interleaved(std::string text);
+
+    //codes each block of block_size bytes on its own, storing it as it is when the
+    //huffman coding would not make it at least min_saving_percent% smaller.
+    std::vector<byte> encode_blocks(
+        std::string text,
+        size_t workers = 1,
+        size_t block_size = DEFAULT_BLOCK_SIZE,
+        size_t min_saving_percent = DEFAULT_MIN_SAVING
+    );
+
+    //same format of encode_blocks, read, encoded and written in overlapping stages,
+    //without holding the whole input in memory.
+    void encode_blocks(
+        std::istream& input,
+        std::ostream& output,
+        size_t workers = 1,
+        size_t block_size = DEFAULT_BLOCK_SIZE,
+        size_t min_saving_percent = DEFAULT_MIN_SAVING
+    );
+
+    //same format of encode_blocks, encoded by a FastFlow pipeline (reader, ordered farm, writer)
+    //with bounded queues, for inputs of unknown length such as pipes. blocks are never repeated.
+    void encode_blocks_ff(
+        std::istream& input,
+        std::ostream& output,
+        size_t workers,
+        size_t block_size = DEFAULT_BLOCK_SIZE,
+        size_t min_saving_percent = DEFAULT_MIN_SAVING
+    );
+
+    std::vector<byte> encode_parallel_native(std::string text, size_t workers, size_t sample_percent = 100);
+
+    //writes the encoded text to the file from byte position: each worker writes the bytes of its own
+    //segment at their place with pwrite, and the bytes shared by two segments are written last.
+    void encode_parallel_native(std::string text, size_t workers, int fd, uint64_t position, size_t sample_percent = 100);
 
     std::vector<byte> encode_parallel_ff(std::string text, size_t workers);
+
+    //streams each encoded segment to the output as soon as it and all the previous ones are done.
+    void encode_parallel_ff(std::string text, size_t workers, std::ostream& output);
+
+    //same as the native version, the segments being written by the workers of the farm.
+    void encode_parallel_ff(std::string text, size_t workers, int fd, uint64_t position);
+
+    //splits the text in chunks of grain_size bytes, dynamically scheduled on a FastFlow ParallelForReduce.
+    std::vector<byte> encode_parallel_ff_for(std::string text, size_t workers, size_t grain_size = DEFAULT_GRAIN_SIZE);
 }
 
 #endif
\ No newline at end of file
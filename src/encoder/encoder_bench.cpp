@@ -0,0 +1,72 @@
+#include "encoder_table.h"
+#include "character_serializer.h"
+
+#include "../bench_utils.h"
+
+#include "../bench/corpus.h"
+
+using namespace huffman;
+using namespace huffman::encoder;
+
+namespace huffman::encoder::detail
+{
+    frequencyMap extract_frequencies(std::string::const_iterator, std::string::const_iterator);
+
+    void extract_frequencies(std::string::const_iterator, std::string::const_iterator, frequencyHistogram&);
+}
+
+constexpr size_t BENCH_TEXT_SIZE = 4 << 20;
+
+void benchExtractFrequencies(const std::string& text) {
+    benchmark("extract_frequencies (map)", text.size(), [&]() {
+        auto frequencies = detail::extract_frequencies(text.cbegin(), text.cend());
+        do_not_optimize(frequencies);
+    });
+
+    auto histogram = frequencyHistogram();
+    benchmark("extract_frequencies (histogram)", text.size(), [&]() {
+        detail::extract_frequencies(text.cbegin(), text.cend(), histogram);
+        do_not_optimize(histogram);
+    });
+}
+
+void benchTable(const std::string& corpus, const std::string& text) {
+    auto frequencies = detail::extract_frequencies(text.cbegin(), text.cend());
+    benchmark("encoderTable (" + corpus + ")", frequencies.size(), [&]() {
+        auto table = encoderTable(frequencies);
+        do_not_optimize(table);
+    });
+
+    auto table = encoderTable(frequencies);
+    benchmark("encoderTable::serialize (" + corpus + ")", 1, [&]() {
+        auto serialized = table.serialize();
+        do_not_optimize(serialized);
+    });
+}
+
+void benchSerializer(const std::string& corpus, const std::string& text) {
+    auto table = encoderTable(detail::extract_frequencies(text.cbegin(), text.cend()));
+
+    std::vector<byte> data;
+    data.reserve(text.size() * 2);
+    benchmark("characterSerializer::append (" + corpus + ")", text.size(), [&]() {
+        data.clear();
+        auto serializer = detail::characterSerializer(table, data);
+        for (auto character : text)
+            serializer.append(character);
+        do_not_optimize(data);
+    });
+}
+
+void benchMain()
+{
+    auto english = bench::generate_corpus("english", BENCH_TEXT_SIZE);
+    benchExtractFrequencies(english);
+
+    //a skewed and a flat table, with long and short codes
+    for (auto corpus : { "english", "uniform" }) {
+        auto text = bench::generate_corpus(corpus, BENCH_TEXT_SIZE);
+        benchTable(corpus, text);
+        benchSerializer(corpus, text);
+    }
+}
\ No newline at end of file
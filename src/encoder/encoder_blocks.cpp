@@ -0,0 +1,365 @@
+#include "encoder.h"
+
+#include <array>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <thread>
+
+#include "encoder_table.h"
+#include "table_cache.h"
+#include "../format.h"
+#include "../utils.h"
+
+#include "../threads/boundedQueue.h"
+#include "../threads/workerPool.h"
+
+#include "../timing.h"
+
+namespace huffman::encoder::detail
+{
+    using namespace huffman::encoder;
+    using namespace huffman::parallel::native;
+
+    void extract_frequencies(std::string::const_iterator, std::string::const_iterator, frequencyHistogram&);
+
+    size_t count_bits(const encoderTable&, const frequencyHistogram&);
+
+    void encode_text(const encoderTable&, std::string::const_iterator, std::string::const_iterator, byte, std::vector<byte>&);
+
+    bool covers(const encoderTable&, const frequencyHistogram&);
+
+    void append_block_header(blockType type, size_t raw_size, size_t payload_size, std::vector<byte>& out_data) {
+        out_data.push_back(static_cast<byte>(type));
+        for (auto size : {raw_size, payload_size}) {
+            auto size_bytes = reinterpret_cast<byte*>(&size);
+            for (size_t i = 0; i < sizeof(size_t); i++)
+                out_data.push_back(size_bytes[i]);
+        }
+    }
+
+    //characters of at most 16 distinct values are written as fixed width indices
+    //(1, 2 or 4 bits) into a list of the characters, most significant bits first.
+    void encode_packed(
+        std::string::const_iterator text_start,
+        std::string::const_iterator text_end,
+        frequencyHistogram const& frequencies,
+        size_t characters,
+        std::vector<byte>& out_data
+    ) {
+        auto indices = std::array<byte, TABLE_SIZE>();
+        out_data.push_back(static_cast<byte>(characters));
+        for (size_t i = 0, index = 0; i < TABLE_SIZE; i++) {
+            if (frequencies[i] == 0) continue;
+
+            indices[i] = index++;
+            out_data.push_back(static_cast<byte>(i));
+        }
+
+        auto width = packed_width(characters);
+        byte current = 0;
+        size_t used_bits = 0;
+        for (auto iter = text_start; iter != text_end; iter++) {
+            current = (current << width) | indices[static_cast<byte>(*iter)];
+            used_bits += width;
+            if (used_bits == 8) {
+                out_data.push_back(current);
+                current = 0;
+                used_bits = 0;
+            }
+        }
+
+        if (used_bits > 0)
+            out_data.push_back(current << (8 - used_bits));
+    }
+
+    //estimate of the size of a huffman block with its own table, made before building it:
+    //the text takes at least its entropy (and one bit per character), the table about three
+    //bytes per character (the character, its length and a code of up to 8 bits).
+    size_t estimate_huffman_size(frequencyHistogram const& frequencies, size_t raw_size, size_t characters) {
+        auto text_bits = std::max(entropy_bits(frequencies), static_cast<double>(raw_size));
+        return 1 + 3 * characters + static_cast<size_t>(text_bits / 8);
+    }
+
+    //the size of the coded block is known from count_bits before encoding it,
+    //so incompressible blocks are copied without going through the serializer.
+    //single character blocks and small alphabets, for which a fixed width code is as
+    //short as the huffman one, skip the serializer as well.
+    //previous_table is the table of the last huffman block, which a repeat block reuses
+    //without serializing it again: when it is cheaper than the estimate of a new table,
+    //the new table is not even built.
+    void encode_block(
+        std::string::const_iterator text_start,
+        std::string::const_iterator text_end,
+        frequencyHistogram const& frequencies,
+        size_t min_saving_percent,
+        std::optional<encoderTable>& previous_table,
+        std::vector<byte>& out_data
+    ) {
+        auto raw_size = static_cast<size_t>(text_end - text_start);
+
+        size_t characters = 0;
+        for (auto frequency : frequencies)
+            if (frequency > 0) characters++;
+
+        if (characters == 1) {
+            append_block_header(blockType::constant, raw_size, 1, out_data);
+            out_data.push_back(static_cast<byte>(*text_start));
+            return;
+        }
+
+        auto stored_limit = raw_size * (100 - min_saving_percent);
+        auto repeat_size = std::numeric_limits<size_t>::max();
+        if (previous_table && covers(*previous_table, frequencies))
+            repeat_size = positive_div_ceil(count_bits(*previous_table, frequencies), static_cast<size_t>(8));
+
+        auto encode_repeat = [&]() {
+            append_block_header(blockType::repeat, raw_size, repeat_size, out_data);
+            encode_text(*previous_table, text_start, text_end, 0, out_data);
+        };
+
+        if (repeat_size <= estimate_huffman_size(frequencies, raw_size, characters) && repeat_size * 100 <= stored_limit) {
+            encode_repeat();
+            return;
+        }
+
+        auto table = encoderTable(frequencies);
+
+        auto table_data = std::vector<byte>();
+        table.serialize(table_data);
+        auto payload_size = table_data.size() + positive_div_ceil(count_bits(table, frequencies), static_cast<size_t>(8));
+
+        auto packed_size = 1 + characters + positive_div_ceil(raw_size * packed_width(characters), static_cast<size_t>(8));
+        bool packed = characters <= MAX_PACKED_CHARACTERS && packed_size <= payload_size;
+        if (packed) payload_size = packed_size;
+
+        if (repeat_size <= payload_size && repeat_size * 100 <= stored_limit) {
+            encode_repeat();
+        } else if (payload_size * 100 > stored_limit) {
+            append_block_header(blockType::stored, raw_size, raw_size, out_data);
+            out_data.insert(out_data.end(), text_start, text_end);
+        } else if (packed) {
+            append_block_header(blockType::packed, raw_size, payload_size, out_data);
+            encode_packed(text_start, text_end, frequencies, characters, out_data);
+        } else {
+            append_block_header(blockType::huffman, raw_size, payload_size, out_data);
+            out_data.insert(out_data.end(), table_data.begin(), table_data.end());
+            encode_text(table, text_start, text_end, 0, out_data);
+            previous_table = std::move(table);
+        }
+    }
+
+    void encode_block(
+        std::string::const_iterator text_start,
+        std::string::const_iterator text_end,
+        size_t min_saving_percent,
+        std::optional<encoderTable>& previous_table,
+        std::vector<byte>& out_data
+    ) {
+        auto frequencies = frequencyHistogram();
+        extract_frequencies(text_start, text_end, frequencies);
+        encode_block(text_start, text_end, frequencies, min_saving_percent, previous_table, out_data);
+    }
+
+    //blocks_per_batch consecutive blocks of the input, with their histograms and encodings.
+    struct blockBatch {
+        std::string text;
+        size_t blocks;
+        std::vector<frequencyHistogram> frequencies;
+        std::vector<std::vector<byte>> encoded_blocks;
+    };
+
+    //reads the next batch and computes the histogram of each block while it is still in cache.
+    bool read_batch(std::istream& input, size_t block_size, size_t blocks_per_batch, blockBatch& batch) {
+        batch.text.resize(block_size * blocks_per_batch);
+        input.read(batch.text.data(), batch.text.size());
+        batch.text.resize(input.gcount());
+
+        batch.blocks = positive_div_ceil(batch.text.size(), block_size);
+        batch.frequencies.resize(batch.blocks);
+        for (size_t i = 0; i < batch.blocks; i++) {
+            auto begin = batch.text.cbegin() + i * block_size;
+            auto end = (i == batch.blocks - 1) ? batch.text.cend() : begin + block_size;
+            extract_frequencies(begin, end, batch.frequencies[i]);
+        }
+
+        return batch.blocks > 0;
+    }
+
+    void write_batch(std::ostream& output, blockBatch const& batch) {
+        for (size_t i = 0; i < batch.blocks; i++)
+            output.write(reinterpret_cast<const char*>(batch.encoded_blocks[i].data()), batch.encoded_blocks[i].size());
+    }
+
+    //a pipeline stage on its own thread. however the stage ends, it closes its queues so that
+    //the stages around it stop too; its exception is kept and rethrown by join.
+    class stageThread {
+    private:
+        std::exception_ptr error;
+        std::thread thread;
+
+    public:
+        template<class Stage, class Close>
+        stageThread(Stage stage, Close close)
+            : thread([this, stage, close]() {
+                try {
+                    stage();
+                } catch (...) {
+                    error = std::current_exception();
+                }
+                close();
+            }) {}
+
+        stageThread(const stageThread&) = delete;
+        stageThread& operator=(const stageThread&) = delete;
+
+        ~stageThread() {
+            if (thread.joinable())
+                thread.join();
+        }
+
+        void join() {
+            thread.join();
+            if (error)
+                std::rethrow_exception(error);
+        }
+    };
+
+    //runs close when it goes out of scope, so that the stage threads are not left blocked
+    //on their queues when the encoding thread leaves with an exception.
+    template<class Close>
+    struct closeOnExit {
+        Close close;
+
+        ~closeOnExit() {
+            close();
+        }
+    };
+}
+
+namespace huffman::encoder
+{
+    using namespace huffman::parallel::native;
+
+    std::vector<byte> encode_blocks(std::string text, size_t workers, size_t block_size, size_t min_saving_percent) {
+        auto serialization_timer = TimingScope("blocks");
+
+        if (block_size == 0) block_size = DEFAULT_BLOCK_SIZE;
+        auto blocks = positive_div_ceil(text.size(), block_size);
+        workers = std::min(std::max<size_t>(workers, 1), std::max<size_t>(blocks, 1));
+
+        //encode each block on its own (map), every worker takes a contiguous run of blocks
+        //so that repeat blocks refer to a table of the same worker
+        auto encoded_blocks = std::vector<std::vector<byte>>(blocks);
+        auto encode_worker_blocks = [&](size_t worker) {
+            auto previous_table = std::optional<encoderTable>();
+            for (size_t i = blocks * worker / workers; i < blocks * (worker + 1) / workers; i++) {
+                auto begin = text.cbegin() + i * block_size;
+                auto end = (i == blocks - 1) ? text.cend() : begin + block_size;
+                detail::encode_block(begin, end, min_saving_percent, previous_table, encoded_blocks[i]);
+            }
+        };
+
+        if (workers > 1) {
+            auto pool = workerPool(workers);
+            pool.run(encode_worker_blocks);
+        } else {
+            encode_worker_blocks(0);
+        }
+
+        //append the blocks in order (reduce)
+        auto out_data = std::vector<byte>();
+        for (auto const& block : encoded_blocks)
+            out_data.insert(out_data.end(), block.begin(), block.end());
+        detail::append_block_header(blockType::end, 0, 0, out_data);
+
+        serialization_timer.stop();
+
+        return out_data;
+    }
+
+    //three stage pipeline: a reader thread reads and histograms batch n + 1 while the workers
+    //encode batch n and a writer thread writes batch n - 1. three batches circulate between
+    //the stages, so the memory used does not depend on the input size.
+    void encode_blocks(std::istream& input, std::ostream& output, size_t workers, size_t block_size, size_t min_saving_percent) {
+        auto serialization_timer = TimingScope("blocks");
+
+        //each worker encodes a run of consecutive blocks of every batch, as in the in memory encoder
+        constexpr size_t BLOCKS_PER_WORKER = 4;
+
+        if (block_size == 0) block_size = DEFAULT_BLOCK_SIZE;
+        workers = std::max<size_t>(workers, 1);
+
+        auto free_batches = boundedQueue<std::unique_ptr<detail::blockBatch>>(3);
+        auto read_batches = boundedQueue<std::unique_ptr<detail::blockBatch>>(1);
+        auto encoded_batches = boundedQueue<std::unique_ptr<detail::blockBatch>>(1);
+        for (size_t i = 0; i < 3; i++)
+            free_batches.push(std::make_unique<detail::blockBatch>());
+
+        auto reader = detail::stageThread([&]() {
+            for (std::unique_ptr<detail::blockBatch> batch; free_batches.pop(batch);) {
+                if (!detail::read_batch(input, block_size, workers * BLOCKS_PER_WORKER, *batch)) break;
+                if (!read_batches.push(std::move(batch))) break;
+            }
+        }, [&]() { read_batches.close(); });
+
+        auto writer = detail::stageThread([&]() {
+            for (std::unique_ptr<detail::blockBatch> batch; encoded_batches.pop(batch);) {
+                detail::write_batch(output, *batch);
+                if (!free_batches.push(std::move(batch))) break;
+            }
+        }, [&]() {
+            free_batches.close();
+            encoded_batches.close();
+        });
+
+        //declared after the stages, so that they are unblocked before being joined
+        auto close_queues = detail::closeOnExit{ [&]() {
+            free_batches.close();
+            read_batches.close();
+            encoded_batches.close();
+        } };
+
+        //the first worker inherits the table of the last one, which encoded the block just before its run
+        auto previous_tables = std::vector<std::optional<encoderTable>>(workers);
+        std::unique_ptr<detail::blockBatch> current;
+        auto encode_worker_blocks = [&](size_t worker) {
+            auto blocks = current->blocks;
+            for (size_t i = blocks * worker / workers; i < blocks * (worker + 1) / workers; i++) {
+                auto begin = current->text.cbegin() + i * block_size;
+                auto end = (i == blocks - 1) ? current->text.cend() : begin + block_size;
+                current->encoded_blocks[i].clear();
+                detail::encode_block(begin, end, current->frequencies[i], min_saving_percent, previous_tables[worker], current->encoded_blocks[i]);
+            }
+        };
+
+        auto pool = std::unique_ptr<workerPool>(workers > 1 ? new workerPool(workers) : nullptr);
+        while (read_batches.pop(current)) {
+            current->encoded_blocks.resize(current->blocks);
+            if (pool) {
+                pool->run(encode_worker_blocks);
+
+                previous_tables[0] = std::move(previous_tables[workers - 1]);
+                for (size_t i = 1; i < workers; i++)
+                    previous_tables[i].reset();
+            } else {
+                encode_worker_blocks(0);
+            }
+
+            //a failed writer has closed the queue
+            if (!encoded_batches.push(std::move(current))) break;
+        }
+
+        encoded_batches.close();
+        writer.join();
+        reader.join();
+
+        auto end_block = std::vector<byte>();
+        detail::append_block_header(blockType::end, 0, 0, end_block);
+        output.write(reinterpret_cast<const char*>(end_block.data()), end_block.size());
+        output.flush();
+
+        serialization_timer.stop();
+    }
+}
\ No newline at end of file
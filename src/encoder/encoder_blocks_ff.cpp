@@ -0,0 +1,121 @@
+#include "encoder.h"
+
+#include <optional>
+
+#include "encoder_table.h"
+#include "../format.h"
+
+#include <ff/ff.hpp>
+#include <ff/pipeline.hpp>
+
+#include "../timing.h"
+
+using namespace ff;
+
+namespace huffman::encoder::detail
+{
+    void append_block_header(blockType, size_t, size_t, std::vector<byte>&);
+
+    void encode_block(std::string::const_iterator, std::string::const_iterator, size_t, std::optional<encoderTable>&, std::vector<byte>&);
+
+    //tasks in flight per queue of the pipeline: when the writer falls behind, the farm and
+    //then the reader block, so the memory used is bounded by the farm width, not by the input.
+    constexpr int STREAM_QUEUE_LENGTH = 2;
+
+    struct block_task {
+        std::string text;
+        std::vector<byte> encoded;
+    };
+
+    //the input is read block by block until its end, which for a pipe is only known when it is closed.
+    struct blockReader: ff_node_t<void*, block_task>
+    {
+    private:
+        std::istream& input;
+        size_t block_size;
+
+    public:
+        blockReader(std::istream& input, size_t block_size)
+            : input(input), block_size(block_size) {}
+
+        block_task* svc(void**) override {
+            while (true) {
+                auto task = new block_task();
+                task->text.resize(block_size);
+                input.read(task->text.data(), block_size);
+                task->text.resize(input.gcount());
+
+                if (task->text.empty()) {
+                    delete task;
+                    return EOS;
+                }
+
+                ff_send_out(task);
+            }
+        }
+    };
+
+    //blocks are encoded on their own: a repeat block would need the table of the block
+    //before it, which may still be in another worker.
+    block_task* encode_block_ff_worker(size_t min_saving_percent, block_task* task, ff_node*) {
+        auto previous_table = std::optional<encoderTable>();
+        encode_block(task->text.cbegin(), task->text.cend(), min_saving_percent, previous_table, task->encoded);
+
+        task->text = std::string();
+        return task;
+    }
+
+    //the ordered farm delivers the blocks in input order.
+    struct blockWriter: ff_node_t<block_task, void>
+    {
+    private:
+        std::ostream& output;
+
+    public:
+        blockWriter(std::ostream& output)
+            : output(output) {}
+
+        void* svc(block_task* task) override {
+            output.write(reinterpret_cast<char*>(task->encoded.data()), task->encoded.size());
+            delete task;
+            return GO_ON;
+        }
+    };
+}
+
+namespace huffman::encoder
+{
+    void encode_blocks_ff(std::istream& input, std::ostream& output, size_t workers, size_t block_size, size_t min_saving_percent) {
+        auto serialization_timer = TimingScope("blocks");
+
+        if (block_size == 0) block_size = DEFAULT_BLOCK_SIZE;
+        workers = std::max<size_t>(workers, 1);
+
+        auto fun = std::function([min_saving_percent](detail::block_task* task, ff_node* n) {
+            return detail::encode_block_ff_worker(min_saving_percent, task, n);
+        });
+
+        auto reader = detail::blockReader(input, block_size);
+        auto farm = ff_OFarm<detail::block_task, detail::block_task>(fun, workers);
+        auto writer = detail::blockWriter(output);
+        farm.setInputQueueLength(detail::STREAM_QUEUE_LENGTH, true);
+        farm.setOutputQueueLength(detail::STREAM_QUEUE_LENGTH, true);
+
+        auto pipe = ff_pipeline();
+        pipe.add_stage(&reader);
+        pipe.add_stage(&farm);
+        pipe.add_stage(&writer);
+        pipe.setXNodeInputQueueLength(detail::STREAM_QUEUE_LENGTH, true);
+        pipe.setXNodeOutputQueueLength(detail::STREAM_QUEUE_LENGTH, true);
+
+        if (pipe.run_and_wait_end() < 0)
+            throw std::runtime_error("FastFlow block pipeline failed.");
+
+        auto end_block = std::vector<byte>();
+        detail::append_block_header(blockType::end, 0, 0, end_block);
+        output.write(reinterpret_cast<const char*>(end_block.data()), end_block.size());
+        output.flush();
+
+        serialization_timer.stop();
+    }
+}
\ No newline at end of file
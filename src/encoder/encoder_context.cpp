@@ -0,0 +1,116 @@
+#include "encoder_context.h"
+
+#include "character_serializer.h"
+#include "../utils.h"
+
+#include "../threads/workerPool.h"
+
+#include <ff/ff.hpp>
+#include <ff/parallel_for.hpp>
+
+namespace huffman::encoder::detail
+{
+    void extract_frequencies(std::string::const_iterator, std::string::const_iterator, frequencyHistogram&);
+
+    size_t count_bits(const encoderTable&, const frequencyHistogram&);
+
+    void append_text_metadata(std::string const&, std::vector<byte>&);
+
+    void encode_text(const encoderTable&, std::string::const_iterator, std::string::const_iterator, byte, std::vector<byte>&);
+
+    void append_text_parallel(std::vector<byte>&, std::vector<byte>&, byte);
+
+    size_t compute_segment_size(std::string const&, size_t);
+
+    std::pair<std::string::const_iterator, std::string::const_iterator> extract_task_range(std::string const&, size_t, size_t, size_t);
+}
+
+namespace huffman::encoder
+{
+    using namespace huffman::parallel::native;
+
+    encoderContext::encoderContext(size_t workers, contextBackend backend, tableCache* cache)
+        : workers(workers == 0 ? 1 : workers), backend(backend),
+            frequencies(this->workers), segments(this->workers), offsets(this->workers), cache(cache)
+    {
+        if (this->workers == 1) return;
+
+        if (backend == contextBackend::native)
+            pool = std::make_unique<workerPool>(this->workers);
+        else
+            ff_pool = std::make_unique<ff::ParallelForReduce<frequencyHistogram>>(this->workers);
+    }
+
+    encoderContext::~encoderContext() = default;
+
+    template<class F>
+    void encoderContext::for_each_worker(F& task) {
+        if (pool) {
+            pool->run(task);
+        } else if (ff_pool) {
+            ff_pool->parallel_for_thid(0, workers, 1, 1, [&task](const long worker, const int) {
+                task(worker);
+            }, workers);
+        } else {
+            for (size_t i = 0; i < workers; i++)
+                task(i);
+        }
+    }
+
+    void encoderContext::encode(const std::string& text, std::vector<byte>& out_data) {
+        auto segment_size = detail::compute_segment_size(text, workers);
+
+        //extract frequencies of letters (map)
+        auto extract = [&](size_t worker) {
+            auto [begin, end] = detail::extract_task_range(text, segment_size, workers, worker);
+            detail::extract_frequencies(begin, end, frequencies[worker]);
+        };
+        for_each_worker(extract);
+
+        //compute total frequencies (reduce)
+        total_frequencies.fill(0);
+        for (auto const& partial : frequencies) {
+            for (size_t i = 0; i < TABLE_SIZE; i++)
+                total_frequencies[i] += partial[i];
+        }
+
+        //build the encoding table, or reuse a cached one with its serialization
+        out_data.clear();
+        if (cache) {
+            cached_table = cache->get(total_frequencies);
+            out_data.insert(out_data.end(), cached_table->serialized.cbegin(), cached_table->serialized.cend());
+        } else {
+            table = encoderTable(total_frequencies);
+            table.serialize(out_data);
+        }
+        auto& encoding_table = last_table();
+
+        //serialize the number of characters in the output array
+        detail::append_text_metadata(text, out_data);
+
+        //compute serialization offsets
+        offsets[0] = 0;
+        for (size_t i = 1; i < workers; i++) {
+            auto previous_bits = detail::count_bits(encoding_table, frequencies[i - 1]);
+            offsets[i] = ((previous_bits + offsets[i - 1]) % 8);
+        }
+
+        //encode text (map)
+        auto encode = [&](size_t worker) {
+            auto [begin, end] = detail::extract_task_range(text, segment_size, workers, worker);
+            segments[worker].clear();
+            detail::encode_text(encoding_table, begin, end, offsets[worker], segments[worker]);
+        };
+        for_each_worker(encode);
+
+        //append serialized text (reduce)
+        for (size_t i = 0; i < workers; i++)
+            detail::append_text_parallel(out_data, segments[i], offsets[i]);
+    }
+
+    std::vector<byte> encoderContext::encode(const std::string& text) {
+        std::vector<byte> out_data;
+        encode(text, out_data);
+        return out_data;
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef HUFFMAN_ENCODER_CONTEXT
+#define HUFFMAN_ENCODER_CONTEXT
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../definitions.h"
+#include "encoder_table.h"
+#include "table_cache.h"
+
+namespace ff
+{
+    template<typename T> class ParallelForReduce;
+}
+
+namespace huffman::parallel::native
+{
+    class workerPool;
+}
+
+namespace huffman::encoder
+{
+    enum class contextBackend {
+        native,
+        fastflow
+    };
+
+    //an encoderContext owns the threads, the per-worker histograms and scratch buffers and
+    //the encoding table, so that many inputs can be encoded one after another without
+    //spawning threads or growing buffers once they have reached their working size.
+    //the output has the same format of encoder::encode.
+    //with a table cache, the tables are taken from (and added to) the cache instead of being built.
+    class encoderContext {
+    private:
+        size_t workers;
+        contextBackend backend;
+        std::unique_ptr<parallel::native::workerPool> pool;
+        std::unique_ptr<ff::ParallelForReduce<frequencyHistogram>> ff_pool;
+
+        std::vector<frequencyHistogram> frequencies;
+        frequencyHistogram total_frequencies;
+        std::vector<std::vector<byte>> segments;
+        std::vector<byte> offsets;
+        encoderTable table;
+        tableCache* cache;
+        std::shared_ptr<const cachedTable> cached_table;
+
+    public:
+        encoderContext(size_t workers = 1, contextBackend backend = contextBackend::native, tableCache* cache = nullptr);
+        encoderContext(const encoderContext&) = delete;
+        encoderContext& operator=(const encoderContext&) = delete;
+
+        ~encoderContext();
+
+        //the output array is cleared, its capacity is reused.
+        void encode(const std::string& text, std::vector<byte>& out_data);
+        std::vector<byte> encode(const std::string& text);
+
+        inline const encoderTable& last_table() const {
+            return cached_table ? cached_table->table : table;
+        }
+
+    private:
+        template<class F> void for_each_worker(F& task);
+    };
+}
+
+#endif
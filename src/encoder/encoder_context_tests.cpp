@@ -0,0 +1,64 @@
+#include "encoder_context.h"
+
+#include "../test_utils.h"
+
+#include "../decoder/decoder.h"
+#include "../decoder/decoder_context.h"
+
+using namespace huffman::encoder;
+using namespace huffman::decoder;
+
+const std::string texts[] = {
+    "this is an example of a huffman tree",
+    "another text, with a different distribution of characters!",
+    "this is an example of a huffman tree",
+    "ab",
+};
+
+void testRoundTrip(size_t workers, contextBackend backend) {
+    auto encoder = encoderContext(workers, backend);
+    auto decoder = decoderContext();
+
+    std::vector<byte> encoded;
+    std::string decoded;
+    for (size_t i = 0; i < 3; i++) {
+        for (auto const& text : texts) {
+            encoder.encode(text, encoded);
+            decoder.decode(encoded, decoded);
+            assert(decoded == text, "Expected decoded text \'", text, "\' but found \'", decoded,
+                "\' with ", workers, " workers");
+            assert(huffman::decoder::decode(encoded) == text, "Expected the stateless decoder to decode \'", text, "\'");
+        }
+    }
+}
+
+void testMoreWorkersThanCharacters() {
+    auto encoder = encoderContext(8);
+    auto text = std::string("abcab");
+    auto decoded = huffman::decoder::decode(encoder.encode(text));
+    assert(decoded == text, "Expected decoded text \'", text, "\' but found \'", decoded, "\'");
+}
+
+void testCachedTables() {
+    auto cache = tableCache();
+    auto encoder = encoderContext(3, contextBackend::native, &cache);
+
+    for (size_t i = 0; i < 3; i++) {
+        for (auto const& text : texts) {
+            auto decoded = huffman::decoder::decode(encoder.encode(text));
+            assert(decoded == text, "Expected decoded text \'", text, "\' but found \'", decoded, "\' with a table cache");
+        }
+    }
+
+    assert(cache.get_misses() <= 3 && cache.get_hits() >= 9, "Expected the repeated texts to reuse their tables, found ",
+        cache.get_hits(), " hits and ", cache.get_misses(), " misses");
+}
+
+void testMain()
+{
+    testRoundTrip(1, contextBackend::native);
+    testRoundTrip(4, contextBackend::native);
+    testRoundTrip(3, contextBackend::fastflow);
+    testMoreWorkersThanCharacters();
+    testCachedTables();
+}
\ No newline at end of file
@@ -0,0 +1,98 @@
+#include "encoder.h"
+
+#include <array>
+
+#include "encoder_table.h"
+#include "character_serializer.h"
+#include "../utils.h"
+
+#include "../timing.h"
+
+namespace huffman::encoder::detail
+{
+    using namespace huffman::encoder;
+
+    void append_text_metadata(std::string const&, std::vector<byte>&);
+
+    void extract_frequencies(std::string::const_iterator, std::string::const_iterator, frequencyHistogram&);
+
+    //the sub-streams are filled in a single pass, each by its own serializer.
+    void encode_text_interleaved(
+        const encoderTable& table,
+        std::string const& text,
+        std::array<std::vector<byte>, INTERLEAVED_STREAMS>& streams
+    ) {
+        for (auto& stream : streams)
+            stream.reserve(text.size() / INTERLEAVED_STREAMS);
+
+        auto serializers = std::array<characterSerializer, INTERLEAVED_STREAMS>{
+            characterSerializer(table, streams[0]),
+            characterSerializer(table, streams[1]),
+            characterSerializer(table, streams[2]),
+            characterSerializer(table, streams[3])
+        };
+
+        size_t i = 0;
+        for (; i + INTERLEAVED_STREAMS <= text.size(); i += INTERLEAVED_STREAMS) {
+            serializers[0].append(text[i]);
+            serializers[1].append(text[i + 1]);
+            serializers[2].append(text[i + 2]);
+            serializers[3].append(text[i + 3]);
+        }
+
+        for (; i < text.size(); i++)
+            serializers[i % INTERLEAVED_STREAMS].append(text[i]);
+    }
+
+    //writes the byte offset of every sub-stream but the first, relative to the start of the first one.
+    void append_stream_offsets(
+        std::array<std::vector<byte>, INTERLEAVED_STREAMS> const& streams,
+        std::vector<byte>& out_data
+    ) {
+        size_t offset = 0;
+        for (size_t i = 0; i < INTERLEAVED_STREAMS - 1; i++) {
+            offset += streams[i].size();
+            auto offset_bytes = reinterpret_cast<byte*>(&offset);
+            for (size_t j = 0; j < sizeof(size_t); j++)
+                out_data.push_back(offset_bytes[j]);
+        }
+    }
+}
+
+namespace huffman::encoder
+{
+    std::vector<byte> encode_interleaved(std::string text) {
+        static_assert(INTERLEAVED_STREAMS == 4, "encode_text_interleaved is unrolled for 4 sub-streams");
+
+        auto frequencies_timer = TimingScope("frequencies");
+
+        //extract frequencies of letters
+        auto frequencies = frequencyHistogram();
+        detail::extract_frequencies(text.cbegin(), text.cend(), frequencies);
+
+        frequencies_timer.stop();
+        auto encodingTable_timer = TimingScope("table");
+
+        //build the encoding table
+        auto table = encoderTable(frequencies);
+
+        encodingTable_timer.stop();
+        auto serialization_timer = TimingScope("serialization");
+
+        //encode text in the sub-streams
+        auto streams = std::array<std::vector<byte>, INTERLEAVED_STREAMS>();
+        detail::encode_text_interleaved(table, text, streams);
+
+        //serialize the table, the number of characters and the sub-stream offsets
+        auto out_data = table.serialize();
+        detail::append_text_metadata(text, out_data);
+        detail::append_stream_offsets(streams, out_data);
+
+        for (auto& stream : streams)
+            out_data.insert(out_data.end(), stream.begin(), stream.end());
+
+        serialization_timer.stop();
+
+        return out_data;
+    }
+}
\ No newline at end of file
@@ -4,17 +4,17 @@
 #include "character_serializer.h"
 #include "../utils.h"
 
+#include "../io/io.h"
+
 #include <ff/ff.hpp>
 
-#ifdef CHRONO_ENABLED
 #include "../timing.h"
-#endif
 
 using namespace ff;
 
 namespace huffman::encoder::detail
 {
-    std::unordered_map<char, int> extract_frequencies(std::string::const_iterator, std::string::const_iterator);
+    frequencyMap extract_frequencies(std::string::const_iterator, std::string::const_iterator);
 
     void append_text_metadata(std::string const&, std::vector<byte>&);
 
@@ -27,19 +27,26 @@ namespace huffman::encoder::detail
 
     std::pair<std::string::const_iterator, std::string::const_iterator> extract_task_range(std::string const&, size_t, size_t, size_t);
 
-    void combine_frequencies(std::unordered_map<char, int>&, std::unordered_map<char, int> const&);
+    void combine_frequencies(frequencyMap&, frequencyMap const&);
+
+    void compute_serialization_offsets(encoderTable const&, std::vector<frequencyMap> const&, std::vector<byte>&, size_t);
+
+    std::vector<size_t> compute_segment_bits(encoderTable const&, std::vector<frequencyMap> const&);
+
+    std::vector<std::pair<uint64_t, byte>> write_segment_interior(int, std::vector<byte> const&, uint64_t, uint64_t);
 
-    void compute_serialization_offsets(encoderTable const&, std::vector<std::unordered_map<char, int>> const&, std::vector<byte>&, size_t);
+    void write_segment_boundaries(int, std::vector<std::pair<uint64_t, byte>>&);
 
     //frequencies extraction farm
     struct frequency_data {
         std::string::const_iterator text_start;
         std::string::const_iterator text_end;
         size_t worker;
+        std::chrono::steady_clock::time_point submitted;
     };
 
     struct frequency_output {
-        std::unordered_map<char, int> frequencies;
+        frequencyMap frequencies;
         size_t worker;
     };
 
@@ -57,18 +64,24 @@ namespace huffman::encoder::detail
             auto segment_size = compute_segment_size(text, workers);
             for(size_t i = 0; i < workers; i++) {
                 auto [begin, end] = extract_task_range(text, segment_size, workers, i);
-                ff_send_out_to(new frequency_data(begin, end, i), i);
+                ff_send_out_to(new frequency_data(begin, end, i, std::chrono::steady_clock::now()), i);
             }
             return EOS;
         }
     };
 
-    frequency_output* extract_frequencies_ff_worker(frequency_data* data, ff_node*) {
+    frequency_output* extract_frequencies_ff_worker(ParallelProfile& profile, frequency_data* data, ff_node*) {
+        auto& record = profile.worker(data->worker);
+        auto start = std::chrono::steady_clock::now();
+        record.queue_wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(start - data->submitted).count();
+        record.bytes_in = data->text_end - data->text_start;
+
         auto result = new frequency_output(
             extract_frequencies(data->text_start, data->text_end),
             data->worker
         );
 
+        record.histogram_ns += elapsed_ns(start);
         delete data;
         return result;
     }
@@ -77,15 +90,17 @@ namespace huffman::encoder::detail
     {
     private:
         size_t workers;
-        std::unordered_map<char, int>& total_frequencies;
-        std::vector<std::unordered_map<char, int>>& frequencies;
+        frequencyMap& total_frequencies;
+        std::vector<frequencyMap>& frequencies;
+        ParallelProfile& profile;
 
     public:
-        frequencyExtractionCollector(size_t workers, std::unordered_map<char, int>& total_frequencies, 
-            std::vector<std::unordered_map<char, int>>& frequencies)
-            : workers(workers), total_frequencies(total_frequencies), frequencies(frequencies) {}
+        frequencyExtractionCollector(size_t workers, frequencyMap& total_frequencies, 
+            std::vector<frequencyMap>& frequencies, ParallelProfile& profile)
+            : workers(workers), total_frequencies(total_frequencies), frequencies(frequencies), profile(profile) {}
 
         void** svc(frequency_output* output) override {
+            auto merge_start = std::chrono::steady_clock::now();
             auto& new_frequencies = output->frequencies;
             auto index = output->worker;
 
@@ -93,21 +108,25 @@ namespace huffman::encoder::detail
             frequencies[index] = new_frequencies;
 
             delete output;
+            profile.add_merge(merge_start);
             return GO_ON;
         }
     };
 
     void extract_frequencies_ff(
-        std::unordered_map<char, int>& total_frequencies,
-        std::vector<std::unordered_map<char, int>>& frequencies,
+        frequencyMap& total_frequencies,
+        std::vector<frequencyMap>& frequencies,
         std::string const& text,
-        size_t workers
+        size_t workers,
+        ParallelProfile& profile
     ) {
         frequencies.resize(workers);
-        auto fun = std::function(&detail::extract_frequencies_ff_worker);
+        auto fun = std::function([&profile](detail::frequency_data* data, ff_node* n) {
+            return detail::extract_frequencies_ff_worker(profile, data, n);
+        });
         auto farm = ff_Farm<detail::frequency_data, detail::frequency_output>(fun, workers);
         auto emitter = detail::frequencyExtractionEmitter(text, workers);
-        auto collector = detail::frequencyExtractionCollector(workers, total_frequencies, frequencies);
+        auto collector = detail::frequencyExtractionCollector(workers, total_frequencies, frequencies, profile);
         farm.add_emitter(emitter);
         farm.add_collector(collector);
         farm.run_and_wait_end();
@@ -119,142 +138,213 @@ namespace huffman::encoder::detail
         std::string::const_iterator text_end;
         size_t worker;
         byte offset;
+        uint64_t start_bit;
+        uint64_t end_bit;
+        std::chrono::steady_clock::time_point submitted;
     };
 
     struct encoder_output {
         std::vector<byte> data;
         size_t worker;
         byte offset;
+        std::vector<std::pair<uint64_t, byte>> boundaries;
     };
     
-    struct encodingEmitter: ff_monode_t<void*, encoder_data>
+    //the emitter of the ordered farm must not pick the workers itself:
+    //tasks are dispatched round-robin and gathered back in the same order.
+    struct encodingEmitter: ff_node_t<void*, encoder_data>
     {
     private:
         std::string const& text;
         encoderTable const& table;
         std::vector<byte>& offsets;
-        std::vector<std::unordered_map<char, int>> const& frequencies;
+        std::vector<frequencyMap> const& frequencies;
         size_t workers;
+        uint64_t position;
+        ParallelProfile& profile;
 
     public:
         encodingEmitter(std::string const& text, encoderTable const& table, std::vector<byte>& offsets, 
-            std::vector<std::unordered_map<char, int>> const& frequencies, size_t workers)
-            : text(text), table(table), offsets(offsets), frequencies(frequencies), workers(workers) {}
+            std::vector<frequencyMap> const& frequencies, size_t workers, uint64_t position, ParallelProfile& profile)
+            : text(text), table(table), offsets(offsets), frequencies(frequencies), workers(workers), position(position), profile(profile) {}
 
         encoder_data* svc(void**) override {
+            auto offsets_start = std::chrono::steady_clock::now();
             compute_serialization_offsets(table, frequencies, offsets, workers);
 
+            //the bits of each segment in the output file, when the workers write to it
+            auto bits = compute_segment_bits(table, frequencies);
+            auto start_bit = position * 8;
+            profile.add_serial(offsets_start);
+
             auto segment_size = compute_segment_size(text, workers);
             for(size_t i = 0; i < workers; i++) {
                 auto [begin, end] = extract_task_range(text, segment_size, workers, i);
-                ff_send_out_to(new encoder_data(begin, end, i, offsets[i]), i);
+                profile.worker(i).bits_out = bits[i];
+                ff_send_out(new encoder_data(begin, end, i, offsets[i], start_bit, start_bit + bits[i], std::chrono::steady_clock::now()));
+                start_bit += bits[i];
             }
 
             return EOS;
         }
     };
 
-    encoder_output* encode_text_ff_worker(const encoderTable& table, encoder_data* data, ff_node*) {
+    //with a file descriptor the worker writes its segment to the file, and passes on only the shared bytes.
+    encoder_output* encode_text_ff_worker(const encoderTable& table, int fd, ParallelProfile& profile, encoder_data* data, ff_node*) {
+        auto& record = profile.worker(data->worker);
+        auto start = std::chrono::steady_clock::now();
+        record.queue_wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(start - data->submitted).count();
+
         auto result = new encoder_output(
             encode_text(table, data->text_start, data->text_end, data->offset),
             data->worker,
             data->offset
         );
 
+        if (fd >= 0) {
+            result->boundaries = write_segment_interior(fd, result->data, data->start_bit, data->end_bit);
+            result->data = std::vector<byte>();
+        }
+
+        record.encode_ns += elapsed_ns(start);
         delete data;
         return result;
     }
 
-    struct encodingCollector: ff_minode_t<encoder_output, void*>
+    //segments are received in order, so each one is appended as soon as it arrives.
+    //if an output stream is given, everything but the last byte (which may still be
+    //shared with the next segment) is flushed to it, keeping only one segment in memory.
+    struct encodingCollector: ff_node_t<encoder_output, void>
     {
     private:
-        size_t workers;
         std::vector<byte>& out_data;
-        std::vector<encoder_output*> in_data;
+        std::ostream* output;
+        int fd;
+        std::vector<std::pair<uint64_t, byte>> boundaries;
+        ParallelProfile& profile;
 
     public:
-        encodingCollector(size_t workers, std::vector<byte>& out_data)
-            : workers(workers), out_data(out_data), in_data(workers) {}
+        encodingCollector(std::vector<byte>& out_data, std::ostream* output, int fd, ParallelProfile& profile)
+            : out_data(out_data), output(output), fd(fd), profile(profile) {}
+
+        void* svc(encoder_output* data) override {
+            auto merge_start = std::chrono::steady_clock::now();
+            if (fd >= 0) {
+                boundaries.insert(boundaries.end(), data->boundaries.begin(), data->boundaries.end());
+                delete data;
+                profile.add_merge(merge_start);
+                return GO_ON;
+            }
 
-        void** svc(encoder_output* data) override {
-            in_data[data->worker] = data;
+            detail::append_text_parallel(out_data, data->data, data->offset);
+            delete data;
+
+            if (output != nullptr && out_data.size() > 1) {
+                output->write(reinterpret_cast<char*>(out_data.data()), out_data.size() - 1);
+                out_data.erase(out_data.begin(), out_data.end() - 1);
+            }
+
+            profile.add_merge(merge_start);
             return GO_ON;
         }
 
         void svc_end() override {
-            for(size_t i = 0; i < workers; i++) {
-                detail::append_text_parallel(out_data, in_data[i]->data, in_data[i]->offset);
-                delete in_data[i];
+            auto merge_start = std::chrono::steady_clock::now();
+            if (fd >= 0)
+                write_segment_boundaries(fd, boundaries);
+
+            if (output != nullptr) {
+                output->write(reinterpret_cast<char*>(out_data.data()), out_data.size());
+                out_data.clear();
             }
+            profile.add_merge(merge_start);
         }
     };
 
     void encode_text_ff(
         encoderTable const& table,
-        std::vector<std::unordered_map<char, int>>& frequencies,
+        std::vector<frequencyMap>& frequencies,
         std::vector<byte>& out_data,
+        std::ostream* output,
+        int fd,
+        uint64_t position,
         std::string const& text,
-        size_t workers
+        size_t workers,
+        ParallelProfile& profile
     ) {
         std::vector<byte> offsets(workers);
-        auto fun = std::function([table](detail::encoder_data* data, ff_node* n) {
-            return detail::encode_text_ff_worker(table, data, n);
+        auto fun = std::function([table, fd, &profile](detail::encoder_data* data, ff_node* n) {
+            return detail::encode_text_ff_worker(table, fd, profile, data, n);
         });
         
-        auto farm = ff_Farm<detail::encoder_data, detail::encoder_output>(fun, workers);
-        auto emitter = detail::encodingEmitter(text, table, offsets, frequencies, workers);
-        auto collector = detail::encodingCollector(workers, out_data);
+        auto farm = ff_OFarm<detail::encoder_data, detail::encoder_output>(fun, workers);
+        auto emitter = detail::encodingEmitter(text, table, offsets, frequencies, workers, position, profile);
+        auto collector = detail::encodingCollector(out_data, output, fd, profile);
         farm.add_emitter(emitter);
         farm.add_collector(collector);
         farm.run_and_wait_end();
     }
 }
 
-namespace huffman::encoder
+namespace huffman::encoder::detail
 {
-    std::vector<byte> encode_parallel_ff(std::string text, size_t workers) {
-#ifdef CHRONO_ENABLED
-        auto& timing = TimingLogger::instance();
-        auto& frequencies_timer = timing.newTimer("02.00 - Extracting letter frequencies from the text (parallel).");
-#endif
+    //the encoded text goes to the output stream or, with a file descriptor, to the file from position.
+    std::vector<byte> encode_parallel_ff(std::string const& text, size_t workers, std::ostream* output, int fd, uint64_t position) {
+        auto profile = ParallelProfile("fastflow", workers);
+        auto frequencies_timer = TimingScope("frequencies");
 
         //extract frequencies of letters (parallelized)
-        std::unordered_map<char, int> total_frequencies;
-        std::vector<std::unordered_map<char, int>> frequencies;
-        detail::extract_frequencies_ff(total_frequencies, frequencies, text, workers);
+        frequencyMap total_frequencies;
+        std::vector<frequencyMap> frequencies;
+        extract_frequencies_ff(total_frequencies, frequencies, text, workers, profile);
 
-#ifdef CHRONO_ENABLED
-        frequencies_timer.stopTimer();
-        auto& encodingTable_timer = timing.newTimer("02.01 - Building encoding table.");
-#endif
+        frequencies_timer.stop();
+        auto encodingTable_timer = TimingScope("table");
+        auto serial_start = std::chrono::steady_clock::now();
 
         auto table = encoderTable(total_frequencies);
 
-#ifdef CHRONO_ENABLED
-        encodingTable_timer.stopTimer();
-        auto& serialization_timer = timing.newTimer("02.02 - Serialization of text.");
-        auto& serialize_metadata_timer = timing.newTimer("02.02a - Serialization of metadata.");
-#endif
+        encodingTable_timer.stop();
+        auto serialization_timer = TimingScope("serialization");
+        auto serialize_metadata_timer = TimingScope("metadata");
 
         //serialize the table in the output array
         auto out_data = table.serialize();
 
         //insert the number of characters
-        detail::append_text_metadata(text, out_data);
+        append_text_metadata(text, out_data);
 
-#ifdef CHRONO_ENABLED
-        serialize_metadata_timer.stopTimer();
-        auto& serialize_text_timer = timing.newTimer("02.02b - Serialization of actual text (parallel).");
-#endif
+        profile.add_serial(serial_start);
+        serialize_metadata_timer.stop();
+        auto serialize_text_timer = TimingScope("text");
+
+        if (fd >= 0) {
+            io::write_at(fd, out_data.data(), out_data.size(), position, io::ioBackend::pread);
+            position += out_data.size();
+            out_data.clear();
+        }
 
         //encode text (parallelized)
-        detail::encode_text_ff(table, frequencies, out_data, text, workers);
+        encode_text_ff(table, frequencies, out_data, output, fd, position, text, workers, profile);
 
-#ifdef CHRONO_ENABLED
-        serialize_text_timer.stopTimer();
-        serialization_timer.stopTimer();
-#endif
+        serialize_text_timer.stop();
+        serialization_timer.stop();
 
         return out_data;
     }
+}
+
+namespace huffman::encoder
+{
+    std::vector<byte> encode_parallel_ff(std::string text, size_t workers) {
+        return detail::encode_parallel_ff(text, workers, nullptr, -1, 0);
+    }
+
+    void encode_parallel_ff(std::string text, size_t workers, std::ostream& output) {
+        detail::encode_parallel_ff(text, workers, &output, -1, 0);
+    }
+
+    void encode_parallel_ff(std::string text, size_t workers, int fd, uint64_t position) {
+        detail::encode_parallel_ff(text, workers, nullptr, fd, position);
+    }
 }
\ No newline at end of file
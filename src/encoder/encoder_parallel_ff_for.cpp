@@ -0,0 +1,164 @@
+#include "encoder.h"
+
+#include <algorithm>
+
+#include "encoder_table.h"
+#include "character_serializer.h"
+#include "../utils.h"
+
+#include <ff/ff.hpp>
+#include <ff/parallel_for.hpp>
+
+#include "../timing.h"
+
+using namespace ff;
+
+namespace huffman::encoder::detail
+{
+    using namespace huffman::encoder;
+
+    std::vector<byte> encode_text(const encoderTable&, std::string::const_iterator, std::string::const_iterator, byte);
+
+    void append_text_metadata(std::string const&, std::vector<byte>&);
+
+    void append_text_parallel(std::vector<byte>&, std::vector<byte>&, byte);
+
+    void extract_frequencies(std::string::const_iterator, std::string::const_iterator, frequencyHistogram&);
+
+    size_t count_bits(const encoderTable&, const frequencyHistogram&);
+
+    std::pair<std::string::const_iterator, std::string::const_iterator> extract_chunk_range(
+        std::string const& text,
+        size_t grain_size,
+        size_t chunk
+    ) {
+        auto begin = text.cbegin() + grain_size * chunk;
+        auto end = (text.cend() - begin > static_cast<long>(grain_size)) ? begin + grain_size : text.cend();
+
+        return { begin, end };
+    }
+
+    //the histogram of each chunk is stored in its own flat array,
+    //while their sum is computed as the reduction variable.
+    void extract_frequencies_ff_for(
+        ParallelForReduce<frequencyHistogram>& pf,
+        frequencyHistogram& total_frequencies,
+        std::vector<frequencyHistogram>& chunk_frequencies,
+        std::string const& text,
+        size_t grain_size,
+        size_t chunks,
+        size_t workers
+    ) {
+        auto identity = frequencyHistogram();
+        identity.fill(0);
+        total_frequencies = identity;
+        chunk_frequencies.resize(chunks);
+        if (chunks == 0) return;
+
+        auto body = [&](const long chunk, frequencyHistogram& partial) {
+            auto [begin, end] = extract_chunk_range(text, grain_size, chunk);
+            auto& row = chunk_frequencies[chunk];
+            extract_frequencies(begin, end, row);
+
+            for (size_t i = 0; i < TABLE_SIZE; i++)
+                partial[i] += row[i];
+        };
+
+        auto reduce = [](frequencyHistogram& total, const frequencyHistogram& partial) {
+            for (size_t i = 0; i < TABLE_SIZE; i++)
+                total[i] += partial[i];
+        };
+
+        pf.parallel_reduce(total_frequencies, identity, 0, chunks, 1, 1, body, reduce, workers);
+    }
+
+    void compute_chunk_offsets(
+        encoderTable const& table,
+        std::vector<frequencyHistogram> const& chunk_frequencies,
+        std::vector<byte>& offsets,
+        size_t chunks
+    ) {
+        offsets.resize(chunks);
+        if (chunks == 0) return;
+
+        offsets[0] = 0;
+        for (size_t i = 1; i < chunks; i++) {
+            auto previous_bits = count_bits(table, chunk_frequencies[i - 1]);
+            offsets[i] = ((previous_bits + offsets[i - 1]) % 8);
+        }
+    }
+
+    void encode_text_ff_for(
+        ParallelForReduce<frequencyHistogram>& pf,
+        encoderTable const& table,
+        std::vector<frequencyHistogram> const& chunk_frequencies,
+        std::vector<byte>& out_data,
+        std::string const& text,
+        size_t grain_size,
+        size_t chunks,
+        size_t workers
+    ) {
+        std::vector<byte> offsets;
+        compute_chunk_offsets(table, chunk_frequencies, offsets, chunks);
+        if (chunks == 0) return;
+
+        //encode chunks (map), the _thid variant is used because the plain parallel_for
+        //of a ParallelForReduce requires the reduction type to be constructible from 0.
+        std::vector<std::vector<byte>> encoded_chunks(chunks);
+        pf.parallel_for_thid(0, chunks, 1, 1, [&](const long chunk, const int) {
+            auto [begin, end] = extract_chunk_range(text, grain_size, chunk);
+            encoded_chunks[chunk] = encode_text(table, begin, end, offsets[chunk]);
+        }, workers);
+
+        //append serialized text (reduce)
+        for (size_t i = 0; i < chunks; i++)
+            append_text_parallel(out_data, encoded_chunks[i], offsets[i]);
+    }
+}
+
+namespace huffman::encoder
+{
+    std::vector<byte> encode_parallel_ff_for(std::string text, size_t workers, size_t grain_size) {
+        auto thread_spawn_timer = TimingScope("spawn threads");
+        grain_size = std::max<size_t>(grain_size, MIN_GRAIN_SIZE);
+
+        //the same runtime is used for both the histogram and the encoding phase
+        auto pf = ParallelForReduce<detail::frequencyHistogram>(workers);
+        auto chunks = positive_div_ceil(text.size(), grain_size);
+
+        thread_spawn_timer.stop();
+        auto frequencies_timer = TimingScope("frequencies");
+
+        //extract frequencies of letters (parallel reduce)
+        detail::frequencyHistogram total_frequencies;
+        std::vector<frequencyHistogram> chunk_frequencies;
+        detail::extract_frequencies_ff_for(pf, total_frequencies, chunk_frequencies, text, grain_size, chunks, workers);
+
+        frequencies_timer.stop();
+        auto encodingTable_timer = TimingScope("table");
+
+        //build the encoding table
+        auto table = encoderTable(total_frequencies);
+
+        encodingTable_timer.stop();
+        auto serialization_timer = TimingScope("serialization");
+        auto serialize_metadata_timer = TimingScope("metadata");
+
+        //serialize the table in the output array
+        auto out_data = table.serialize();
+
+        //insert the number of characters
+        detail::append_text_metadata(text, out_data);
+
+        serialize_metadata_timer.stop();
+        auto serialize_text_timer = TimingScope("text");
+
+        //encode text (parallel for)
+        detail::encode_text_ff_for(pf, table, chunk_frequencies, out_data, text, grain_size, chunks, workers);
+
+        serialize_text_timer.stop();
+        serialization_timer.stop();
+
+        return out_data;
+    }
+}
@@ -1,26 +1,31 @@
 #include "encoder.h"
 
+#include <algorithm>
+
 #include "encoder_table.h"
 #include "character_serializer.h"
 #include "../utils.h"
 
+#include "../io/io.h"
 #include "../threads/threadTask.h"
 
-#ifdef CHRONO_ENABLED
 #include "../timing.h"
-#endif
 
 namespace huffman::encoder::detail
 {
     using namespace huffman::encoder;
     using namespace huffman::parallel::native;
 
-    std::unordered_map<char, int> extract_frequencies(std::string::const_iterator, std::string::const_iterator);
+    frequencyMap extract_frequencies(std::string::const_iterator, std::string::const_iterator);
 
     void append_text_metadata(std::string const&, std::vector<byte>&);
 
     std::vector<byte> encode_text(const encoderTable&, std::string::const_iterator, std::string::const_iterator, byte);
 
+    void extract_frequencies_sampled(std::string::const_iterator, std::string::const_iterator, size_t, frequencyHistogram&);
+
+    size_t encode_text_aligned(const encoderTable&, std::string::const_iterator, std::string::const_iterator, std::vector<byte>&);
+
     std::vector<threadTask> spawnThreads(size_t workers) {
         std::vector<threadTask> threads(workers);
         for(size_t i = 0; i < workers; i++) {
@@ -43,15 +48,16 @@ namespace huffman::encoder::detail
         size_t workers,
         size_t worker_num
     ) {
-        auto begin = text.cbegin() + segment_size * worker_num;
-        auto end = (worker_num == workers - 1) ? text.cend() : begin + segment_size;
+        //segments past the end of the text (when there are more workers than characters) are empty.
+        auto begin = text.cbegin() + std::min(segment_size * worker_num, text.size());
+        auto end = (worker_num == workers - 1) ? text.cend() : text.cbegin() + std::min(segment_size * (worker_num + 1), text.size());
 
         return { begin, end };
     }
 
     void combine_frequencies(
-        std::unordered_map<char, int>& total_frequencies,
-        std::unordered_map<char, int> const& partial_frequencies
+        frequencyMap& total_frequencies,
+        frequencyMap const& partial_frequencies
     ) {
         for(auto const& pair : partial_frequencies) {
             if (total_frequencies.find(pair.first) != total_frequencies.end())
@@ -63,33 +69,55 @@ namespace huffman::encoder::detail
 
     void extract_frequencies_parallel(
         std::vector<threadTask>& threads,
-        std::unordered_map<char, int>& total_frequencies,
-        std::vector<std::unordered_map<char, int>>& frequencies,
+        frequencyMap& total_frequencies,
+        std::vector<frequencyMap>& frequencies,
         std::string const& text,
-        size_t workers
+        size_t workers,
+        ParallelProfile& profile
     ) {
         using threadResultFrequencies =
             threadResult<
-                std::unordered_map<char, int>,
+                frequencyMap,
+                std::string::const_iterator,
                 std::string::const_iterator,
-                std::string::const_iterator
+                size_t,
+                std::chrono::steady_clock::time_point
             >;
 
         std::vector<threadResultFrequencies> work_threads(workers);
 
+        //wrapper function which times the task, from its submission
+        auto fun = std::function([&profile](
+            std::string::const_iterator text_start,
+            std::string::const_iterator text_end,
+            size_t worker,
+            std::chrono::steady_clock::time_point submitted
+        ) {
+            auto& record = profile.worker(worker);
+            auto start = std::chrono::steady_clock::now();
+            record.queue_wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(start - submitted).count();
+            record.bytes_in = text_end - text_start;
+
+            auto frequencies = extract_frequencies(text_start, text_end);
+            record.histogram_ns += elapsed_ns(start);
+            return frequencies;
+        });
+
         //submit tasks (map)
         auto segment_size = compute_segment_size(text, workers);
-        auto fun = std::function(&extract_frequencies);
         for(size_t i = 0; i < workers; i++) {
             auto [begin, end] = extract_task_range(text, segment_size, workers, i);
-            work_threads[i] = submitTask(std::move(threads[i]), fun, begin, end);
+            work_threads[i] = submitTask(std::move(threads[i]), fun, begin, end, i, std::chrono::steady_clock::now());
         }
 
         //compute total frequencies (reduce)
         frequencies.resize(workers);
         for(size_t i = 0; i < workers; i++) {
             threads[i] = getResult(std::move(work_threads[i]), frequencies[i]);
+
+            auto merge_start = std::chrono::steady_clock::now();
             combine_frequencies(total_frequencies, frequencies[i]);
+            profile.add_merge(merge_start);
         }
     }
 
@@ -108,7 +136,7 @@ namespace huffman::encoder::detail
         }
     }
 
-    inline size_t count_bits(const encoderTable& table, std::unordered_map<char, int> frequencies) {
+    inline size_t count_bits(const encoderTable& table, frequencyMap frequencies) {
         size_t bits = 0;
         for(auto const [character, frequency] : frequencies)
             bits += table.get(character).bits * frequency;
@@ -116,9 +144,20 @@ namespace huffman::encoder::detail
         return bits;
     }
 
+    std::vector<size_t> compute_segment_bits(
+        encoderTable const& table,
+        std::vector<frequencyMap> const& frequencies
+    ) {
+        std::vector<size_t> bits(frequencies.size());
+        for(size_t i = 0; i < frequencies.size(); i++)
+            bits[i] = count_bits(table, frequencies[i]);
+
+        return bits;
+    }
+
     void compute_serialization_offsets(
         encoderTable const& table,
-        std::vector<std::unordered_map<char, int>> const& frequencies,
+        std::vector<frequencyMap> const& frequencies,
         std::vector<byte>& offsets,
         size_t workers
     ) {
@@ -133,104 +172,363 @@ namespace huffman::encoder::detail
 
     void encode_text_parallel(
         std::vector<threadTask>& threads,
-        std::vector<std::unordered_map<char, int>>& frequencies,
+        std::vector<frequencyMap>& frequencies,
         std::vector<byte>& out_data,
         encoderTable const& table,
         std::string const& text,
-        size_t workers
+        size_t workers,
+        ParallelProfile& profile
     ) {
         using threadResultEncoding = threadResult<
             std::vector<byte>,
             std::string::const_iterator,
             std::string::const_iterator,
-            byte
+            byte,
+            size_t,
+            std::chrono::steady_clock::time_point
         >;
 
         std::vector<threadResultEncoding> work_threads(workers);
 
         //wrapper function which captures the local environment
-        auto fun = std::function([table](
+        auto fun = std::function([table, &profile](
             std::string::const_iterator text_start,
             std::string::const_iterator text_end,
-            byte offset
+            byte offset,
+            size_t worker,
+            std::chrono::steady_clock::time_point submitted
         ) {
-            return encode_text(table, text_start, text_end, offset);
+            auto& record = profile.worker(worker);
+            auto start = std::chrono::steady_clock::now();
+            record.queue_wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(start - submitted).count();
+
+            auto data = encode_text(table, text_start, text_end, offset);
+            record.encode_ns += elapsed_ns(start);
+            return data;
         });
 
         //compute serialization offsets
+        auto offsets_start = std::chrono::steady_clock::now();
         std::vector<byte> offsets;
         compute_serialization_offsets(table, frequencies, offsets, workers);
+        auto bits = compute_segment_bits(table, frequencies);
+        profile.add_serial(offsets_start);
 
         //submit tasks (map)
         auto segment_size = compute_segment_size(text, workers);
         for(size_t i = 0; i < workers; i++) {
             auto [begin, end] = extract_task_range(text, segment_size, workers, i);
-            work_threads[i] = submitTask(std::move(threads[i]), fun, begin, end, offsets[i]);
+            profile.worker(i).bits_out = bits[i];
+            work_threads[i] = submitTask(std::move(threads[i]), fun, begin, end, offsets[i], i, std::chrono::steady_clock::now());
         }
 
         //append serialized text (reduce)
         for(size_t i = 0; i < workers; i++) {
             std::vector<byte> data;
             threads[i] = getResult(std::move(work_threads[i]), data);
+
+            auto merge_start = std::chrono::steady_clock::now();
             detail::append_text_parallel(out_data, data, offsets[i]);
+            profile.add_merge(merge_start);
+        }
+    }
+
+    //writes the bytes of an encoded segment, which spans bits [start_bit, end_bit) of the file, that
+    //no other segment shares. the first and the last byte, which may be shared with the segments
+    //next to it, are returned with their position instead, to be merged once all are done.
+    std::vector<std::pair<uint64_t, byte>> write_segment_interior(
+        int fd,
+        std::vector<byte> const& data,
+        uint64_t start_bit,
+        uint64_t end_bit
+    ) {
+        std::vector<std::pair<uint64_t, byte>> boundaries;
+        if (start_bit == end_bit) return boundaries;
+
+        auto position = start_bit / 8;
+        size_t begin = (start_bit % 8 != 0) ? 1 : 0;
+        size_t end = data.size() - ((end_bit % 8 != 0) ? 1 : 0);
+
+        if (begin == 1)
+            boundaries.emplace_back(position, data.front());
+        if (end < data.size() && end >= begin)
+            boundaries.emplace_back(position + data.size() - 1, data.back());
+        if (end > begin)
+            io::write_at(fd, data.data() + begin, end - begin, position + begin, io::default_backend());
+
+        return boundaries;
+    }
+
+    //the bits of the segments sharing a byte are disjoint, so their bytes are merged with an or.
+    void write_segment_boundaries(int fd, std::vector<std::pair<uint64_t, byte>>& boundaries) {
+        std::sort(boundaries.begin(), boundaries.end());
+
+        for(size_t i = 0; i < boundaries.size();) {
+            auto [position, value] = boundaries[i++];
+            for(; i < boundaries.size() && boundaries[i].first == position; i++)
+                value |= boundaries[i].second;
+
+            io::write_at(fd, &value, 1, position, io::ioBackend::pread);
+        }
+    }
+
+    //each worker writes its segment to the file as soon as it is encoded, from the position the
+    //bits of the previous segments lead to: the encoded text is never gathered in memory.
+    void encode_text_parallel(
+        std::vector<threadTask>& threads,
+        std::vector<frequencyMap>& frequencies,
+        int fd,
+        uint64_t position,
+        encoderTable const& table,
+        std::string const& text,
+        size_t workers,
+        ParallelProfile& profile
+    ) {
+        using segmentBoundaries = std::vector<std::pair<uint64_t, byte>>;
+        using threadResultEncoding = threadResult<
+            segmentBoundaries,
+            std::string::const_iterator,
+            std::string::const_iterator,
+            uint64_t,
+            uint64_t,
+            size_t,
+            std::chrono::steady_clock::time_point
+        >;
+
+        std::vector<threadResultEncoding> work_threads(workers);
+
+        //wrapper function which captures the local environment, the write being part of the encoding
+        auto fun = std::function([&table, fd, &profile](
+            std::string::const_iterator text_start,
+            std::string::const_iterator text_end,
+            uint64_t start_bit,
+            uint64_t end_bit,
+            size_t worker,
+            std::chrono::steady_clock::time_point submitted
+        ) {
+            auto& record = profile.worker(worker);
+            auto start = std::chrono::steady_clock::now();
+            record.queue_wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(start - submitted).count();
+
+            auto data = encode_text(table, text_start, text_end, start_bit % 8);
+            auto boundaries = write_segment_interior(fd, data, start_bit, end_bit);
+            record.encode_ns += elapsed_ns(start);
+            return boundaries;
+        });
+
+        //compute the first bit of each segment in the file
+        auto offsets_start = std::chrono::steady_clock::now();
+        auto bits = compute_segment_bits(table, frequencies);
+        std::vector<uint64_t> start_bits(workers + 1, position * 8);
+        for(size_t i = 0; i < workers; i++)
+            start_bits[i + 1] = start_bits[i] + bits[i];
+        profile.add_serial(offsets_start);
+
+        //submit tasks (map)
+        auto segment_size = compute_segment_size(text, workers);
+        for(size_t i = 0; i < workers; i++) {
+            auto [begin, end] = extract_task_range(text, segment_size, workers, i);
+            profile.worker(i).bits_out = bits[i];
+            work_threads[i] = submitTask(std::move(threads[i]), fun, begin, end, start_bits[i], start_bits[i + 1], i, std::chrono::steady_clock::now());
+        }
+
+        //write the shared bytes (reduce)
+        segmentBoundaries boundaries;
+        for(size_t i = 0; i < workers; i++) {
+            segmentBoundaries segment_boundaries;
+            threads[i] = getResult(std::move(work_threads[i]), segment_boundaries);
+            boundaries.insert(boundaries.end(), segment_boundaries.begin(), segment_boundaries.end());
+        }
+
+        auto merge_start = std::chrono::steady_clock::now();
+        write_segment_boundaries(fd, boundaries);
+        profile.add_merge(merge_start);
+    }
+
+    //shifts an encoded text, which starts from a byte boundary, to the right by offset bits.
+    void shift_encoded_text(std::vector<byte>* data, size_t bits, byte offset) {
+        if (offset == 0 || bits == 0) return;
+
+        auto old_size = data->size();
+        auto new_size = positive_div_ceil(bits + offset, static_cast<size_t>(8));
+        data->resize(new_size, 0);
+
+        //walking backwards, every byte is read before being overwritten
+        for (size_t i = new_size; i-- > 0;) {
+            byte high = (i < old_size) ? ((*data)[i] >> offset) : 0;
+            byte low = (i > 0 && i - 1 < old_size) ? static_cast<byte>((*data)[i - 1] << (8 - offset)) : 0;
+            (*data)[i] = high | low;
+        }
+    }
+
+    //without the frequencies of each segment the offsets are not known in advance: the segments
+    //are encoded from a byte boundary and then each worker shifts its own once the offsets are known.
+    void encode_text_parallel_shifted(
+        std::vector<threadTask>& threads,
+        std::vector<byte>& out_data,
+        encoderTable const& table,
+        std::string const& text,
+        size_t workers,
+        ParallelProfile& profile
+    ) {
+        using encodedSegment = std::pair<std::vector<byte>, size_t>;
+        using threadResultEncoding = threadResult<
+            encodedSegment,
+            std::string::const_iterator,
+            std::string::const_iterator,
+            size_t,
+            std::chrono::steady_clock::time_point
+        >;
+        using threadResultShift = threadResult<void, std::vector<byte>*, size_t, byte, size_t, std::chrono::steady_clock::time_point>;
+
+        std::vector<threadResultEncoding> work_threads(workers);
+        std::vector<threadResultShift> shift_threads(workers);
+
+        //wrapper function which captures the local environment
+        auto fun = std::function([table, &profile](
+            std::string::const_iterator text_start,
+            std::string::const_iterator text_end,
+            size_t worker,
+            std::chrono::steady_clock::time_point submitted
+        ) {
+            auto& record = profile.worker(worker);
+            auto start = std::chrono::steady_clock::now();
+            record.queue_wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(start - submitted).count();
+            record.bytes_in = text_end - text_start;
+
+            auto segment = encodedSegment();
+            segment.second = encode_text_aligned(table, text_start, text_end, segment.first);
+            record.bits_out = segment.second;
+            record.encode_ns += elapsed_ns(start);
+            return segment;
+        });
+
+        //the shift is part of the encoding of the segment
+        auto shift = std::function([&profile](
+            std::vector<byte>* data,
+            size_t bits,
+            byte offset,
+            size_t worker,
+            std::chrono::steady_clock::time_point submitted
+        ) {
+            auto& record = profile.worker(worker);
+            auto start = std::chrono::steady_clock::now();
+            record.queue_wait_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(start - submitted).count();
+
+            shift_encoded_text(data, bits, offset);
+            record.encode_ns += elapsed_ns(start);
+        });
+
+        //submit tasks (map)
+        auto segment_size = compute_segment_size(text, workers);
+        for(size_t i = 0; i < workers; i++) {
+            auto [begin, end] = extract_task_range(text, segment_size, workers, i);
+            work_threads[i] = submitTask(std::move(threads[i]), fun, begin, end, i, std::chrono::steady_clock::now());
+        }
+
+        //compute serialization offsets from the number of bits of each segment
+        std::vector<encodedSegment> segments(workers);
+        std::vector<byte> offsets(workers);
+        for(size_t i = 0; i < workers; i++) {
+            threads[i] = getResult(std::move(work_threads[i]), segments[i]);
+            offsets[i] = (i == 0) ? 0 : ((offsets[i - 1] + segments[i - 1].second) % 8);
+        }
+
+        //align the segments to their offsets (map)
+        for(size_t i = 0; i < workers; i++) {
+            shift_threads[i] = submitTask(std::move(threads[i]), shift, &segments[i].first, segments[i].second, offsets[i], i, std::chrono::steady_clock::now());
+        }
+
+        //append serialized text (reduce)
+        for(size_t i = 0; i < workers; i++) {
+            threads[i] = getResult(std::move(shift_threads[i]));
+
+            auto merge_start = std::chrono::steady_clock::now();
+            detail::append_text_parallel(out_data, segments[i].first, offsets[i]);
+            profile.add_merge(merge_start);
         }
     }
 }
 
-namespace huffman::encoder
+namespace huffman::encoder::detail
 {
-    std::vector<byte> encode_parallel_native(std::string text, size_t workers) {
-#ifdef CHRONO_ENABLED
-        auto& timing = TimingLogger::instance();
-        auto& thread_spawn_timer = timing.newTimer("02.** - Thread spawning.");
-#endif
+    //with a file descriptor the encoded text is written to the file from position instead of being returned.
+    std::vector<byte> encode_parallel_native(std::string const& text, size_t workers, size_t sample_percent, int fd, uint64_t position) {
+        auto profile = ParallelProfile("native", workers);
+        auto thread_spawn_timer = TimingScope("spawn threads");
+        auto serial_start = std::chrono::steady_clock::now();
 
         //spawn necessary threads
-        auto threads = detail::spawnThreads(workers);
-
-#ifdef CHRONO_ENABLED
-        thread_spawn_timer.stopTimer();
-        auto& frequencies_timer = timing.newTimer("02.00 - Extracting letter frequencies from the text (parallel).");
-#endif
-
-        //extract frequencies of letters (parallelized)
-        std::unordered_map<char, int> total_frequencies;
-        std::vector<std::unordered_map<char, int>> frequencies;
-        detail::extract_frequencies_parallel(threads, total_frequencies, frequencies, text, workers);
+        auto threads = spawnThreads(workers);
+
+        profile.add_serial(serial_start);
+        thread_spawn_timer.stop();
+        auto frequencies_timer = TimingScope("frequencies");
+
+        //extract frequencies of letters (parallelized), or from a sample of the text
+        frequencyMap total_frequencies;
+        std::vector<frequencyMap> frequencies;
+        auto sampled_frequencies = frequencyHistogram();
+        if (sample_percent < 100) {
+            serial_start = std::chrono::steady_clock::now();
+            extract_frequencies_sampled(text.cbegin(), text.cend(), sample_percent, sampled_frequencies);
+            profile.add_serial(serial_start);
+        } else {
+            extract_frequencies_parallel(threads, total_frequencies, frequencies, text, workers, profile);
+        }
 
-#ifdef CHRONO_ENABLED
-        frequencies_timer.stopTimer();
-        auto& encodingTable_timer = timing.newTimer("02.01 - Building encoding table.");
-#endif
+        frequencies_timer.stop();
+        auto encodingTable_timer = TimingScope("table");
+        serial_start = std::chrono::steady_clock::now();
 
         //build the encoding table
-        auto table = encoderTable(total_frequencies);
+        auto table = (sample_percent < 100) ? encoderTable(sampled_frequencies) : encoderTable(total_frequencies);
 
-#ifdef CHRONO_ENABLED
-        encodingTable_timer.stopTimer();
-        auto& serialization_timer = timing.newTimer("02.02 - Serialization of text.");
-        auto& serialize_metadata_timer = timing.newTimer("02.02a - Serialization of metadata.");
-#endif
+        encodingTable_timer.stop();
+        auto serialization_timer = TimingScope("serialization");
+        auto serialize_metadata_timer = TimingScope("metadata");
 
         //serialize the table in the output array
         auto out_data = table.serialize();
 
         //insert the number of characters
-        detail::append_text_metadata(text, out_data);
-
-#ifdef CHRONO_ENABLED
-        serialize_metadata_timer.stopTimer();
-        auto& serialize_text_timer = timing.newTimer("02.02b - Serialization of actual text (parallel).");
-#endif
+        append_text_metadata(text, out_data);
+
+        profile.add_serial(serial_start);
+        serialize_metadata_timer.stop();
+        auto serialize_text_timer = TimingScope("text");
+
+        //encode text (parallelized). the sampled table leaves the size of the
+        //segments unknown until they are encoded, so they are gathered first
+        if (sample_percent < 100) {
+            encode_text_parallel_shifted(threads, out_data, table, text, workers, profile);
+        } else if (fd >= 0) {
+            io::write_at(fd, out_data.data(), out_data.size(), position, io::ioBackend::pread);
+            encode_text_parallel(threads, frequencies, fd, position + out_data.size(), table, text, workers, profile);
+            out_data.clear();
+        } else {
+            encode_text_parallel(threads, frequencies, out_data, table, text, workers, profile);
+        }
 
-        //encode text (parallelized)
-        detail::encode_text_parallel(threads, frequencies, out_data, table, text, workers);
+        if (fd >= 0 && !out_data.empty()) {
+            io::write_at(fd, out_data.data(), out_data.size(), position, io::default_backend());
+            out_data.clear();
+        }
 
-#ifdef CHRONO_ENABLED
-        serialize_text_timer.stopTimer();
-        serialization_timer.stopTimer();
-#endif
+        serialize_text_timer.stop();
+        serialization_timer.stop();
 
         return out_data;
     }
+}
+
+namespace huffman::encoder
+{
+    std::vector<byte> encode_parallel_native(std::string text, size_t workers, size_t sample_percent) {
+        return detail::encode_parallel_native(text, workers, sample_percent, -1, 0);
+    }
+
+    void encode_parallel_native(std::string text, size_t workers, int fd, uint64_t position, size_t sample_percent) {
+        detail::encode_parallel_native(text, workers, sample_percent, fd, position);
+    }
 }
\ No newline at end of file
@@ -0,0 +1,107 @@
+#include "encoder.h"
+
+#include "../test_utils.h"
+
+#include "../file_utils.h"
+#include "../timing.h"
+
+#include <filesystem>
+
+#include <unistd.h>
+
+using namespace huffman;
+
+std::string parallel_text(size_t size) {
+    std::string text;
+    for (size_t i = 0; text.size() < size; i++)
+        text += "segment " + std::to_string(i * i % 331) + (i % 5 == 0 ? " of the text\n" : " ");
+
+    text.resize(size);
+    return text;
+}
+
+//the file written by the workers is compared to the encoded text gathered in memory,
+//after a prefix which the encoder must leave untouched.
+template<class FileEncoder>
+void assertSameOutput(const std::string& text, const std::vector<byte>& expected, FileEncoder encode_to_file, const char* encoder) {
+    auto filename = (std::filesystem::temp_directory_path() / "huffman_encoder_parallel_tests").string();
+    {
+        auto output = fileDescriptor{ open_output_file(filename) };
+        auto prefix = std::string("HH");
+        assert(::write(output.fd, prefix.data(), prefix.size()) == 2, "Could not write the prefix.");
+        encode_to_file(output.fd, prefix.size());
+    }
+
+    auto written = read_binary_file(filename);
+    std::filesystem::remove(filename);
+
+    auto same = written.size() == expected.size() + 2 && std::equal(expected.begin(), expected.end(), written.begin() + 2);
+    assert(same && written[0] == 'H' && written[1] == 'H', "The ", encoder, " encoder wrote a different file for ", text.size(), " characters.");
+}
+
+void testFileOutput() {
+    for (size_t size : { 0, 1, 7, 100, 4096, 250003 }) {
+        auto text = parallel_text(size);
+
+        for (size_t workers : { 1, 2, 3, 7 }) {
+            auto native = encoder::encode_parallel_native(text, workers);
+            assertSameOutput(text, native, [&](int fd, uint64_t position) {
+                encoder::encode_parallel_native(text, workers, fd, position);
+            }, "native");
+
+            auto sampled = encoder::encode_parallel_native(text, workers, 50);
+            assertSameOutput(text, sampled, [&](int fd, uint64_t position) {
+                encoder::encode_parallel_native(text, workers, fd, position, 50);
+            }, "sampled native");
+
+            auto fastflow = encoder::encode_parallel_ff(text, workers);
+            assertSameOutput(text, fastflow, [&](int fd, uint64_t position) {
+                encoder::encode_parallel_ff(text, workers, fd, position);
+            }, "FastFlow");
+        }
+    }
+}
+
+//with profiling enabled each run records its workers, whose segments add up to the text.
+void testWorkerRecords() {
+    auto& timing = TimingLogger::instance();
+    auto was_enabled = timing.is_enabled();
+    timing.enable(true);
+    timing.clear();
+
+    auto text = parallel_text(100000);
+    auto native = encoder::encode_parallel_native(text, 3);
+    auto sampled = encoder::encode_parallel_native(text, 3, 50);
+    auto fastflow = encoder::encode_parallel_ff(text, 3);
+
+    auto runs = timing.parallel_runs();
+    timing.enable(was_enabled);
+    timing.clear();
+
+    assert(runs.size() == 3, "Expected 3 parallel runs, got ", runs.size(), ".");
+    assert(runs[0].encoder == "native" && runs[2].encoder == "fastflow", "The runs are recorded in the wrong order.");
+
+    std::vector<uint64_t> bits;
+    for (auto& run : runs) {
+        uint64_t bytes_in = 0, bits_out = 0;
+        for (auto& worker : run.workers) {
+            bytes_in += worker.bytes_in;
+            bits_out += worker.bits_out;
+        }
+        bits.push_back(bits_out);
+
+        assert(run.workers.size() == 3, "Expected 3 workers, got ", run.workers.size(), ".");
+        assert(bytes_in == text.size(), "The ", run.encoder, " workers read ", bytes_in, " bytes of ", text.size(), ".");
+        assert(run.imbalance() >= 1 && run.serial_fraction() >= 0 && run.serial_fraction() <= 1,
+            "Unexpected imbalance ", run.imbalance(), " or serial fraction ", run.serial_fraction(), ".");
+    }
+
+    assert(bits[0] == bits[2], "The native and FastFlow workers wrote ", bits[0], " and ", bits[2], " bits.");
+    assert(bits[0] <= native.size() * 8 && bits[1] <= sampled.size() * 8, "The workers wrote more bits than the encoded text.");
+}
+
+void testMain()
+{
+    testFileOutput();
+    testWorkerRecords();
+}
\ No newline at end of file
@@ -1,84 +1,118 @@
 #include "encoder_table.h"
 
 #include <algorithm>
+#include <cstdint>
 #include <unordered_map>
-#include <memory>
 
 #include "serializable_character.h"
 #include "../utils.h"
 
 namespace huffman::encoder::detail
 {
-    struct encoderTree {
-        char character;
-        int frequency;
-        std::unique_ptr<encoderTree> left, right;
-    };
-
-    bool heap_compare(const std::unique_ptr<encoderTree>& lhs, const std::unique_ptr<encoderTree>& rhs) {
-        return lhs->frequency > rhs->frequency || (lhs->frequency == rhs->frequency && lhs->character < rhs->character);
-    }
-
-    std::unique_ptr<encoderTree> build_encoder_tree(const std::unordered_map<char, int>& frequencies) {
-        auto heap = std::vector<std::unique_ptr<encoderTree>>();
-        heap.reserve(frequencies.size());
-
-        for (auto const& [character, frequency] : frequencies) {
-            auto node = std::make_unique<encoderTree>();
-            node->character = character;
-            node->frequency = frequency;
-            heap.emplace_back(std::move(node));
+    //Moffat and Katajainen's in-place computation of minimum redundancy code lengths:
+    //on input weights holds the n weights in increasing order, on output their code lengths.
+    //the first pass builds the tree, storing in place of merged nodes their parent index,
+    //the second one turns parents into internal node depths, the last one leaf depths.
+    void compute_code_lengths(uint64_t* weights, size_t n) {
+        if (n == 0) return;
+        if (n == 1) {
+            weights[0] = 0;
+            return;
         }
 
-        std::make_heap(heap.begin(), heap.end(), heap_compare);
-
-        while (!heap.empty()) {
-            std::pop_heap(heap.begin(), heap.end(), heap_compare);
-            auto smallest_1 = std::move(heap.back()); heap.pop_back();
+        weights[0] += weights[1];
+        size_t root = 0;
+        size_t leaf = 2;
+        for (size_t next = 1; next < n - 1; next++) {
+            //first child of the next internal node, either a leaf or an internal node
+            if (leaf >= n || weights[root] < weights[leaf]) {
+                weights[next] = weights[root];
+                weights[root++] = next;
+            } else {
+                weights[next] = weights[leaf++];
+            }
 
-            if (heap.empty()) {
-                return smallest_1;
+            //second child
+            if (leaf >= n || (root < next && weights[root] < weights[leaf])) {
+                weights[next] += weights[root];
+                weights[root++] = next;
             } else {
-                std::pop_heap(heap.begin(), heap.end(), heap_compare);
-                auto smallest_2 = std::move(heap.back()); heap.pop_back();
+                weights[next] += weights[leaf++];
+            }
+        }
 
-                auto node = std::make_unique<encoderTree>();
-                node->character = '\0';
-                node->frequency = smallest_1->frequency + smallest_2->frequency;
-                node->left = std::move(smallest_1);
-                node->right = std::move(smallest_2);
+        weights[n - 2] = 0;
+        for (size_t next = n - 2; next-- > 0;)
+            weights[next] = weights[weights[next]] + 1;
+
+        long long internal = n - 2;
+        long long next = n - 1;
+        size_t available = 1;
+        uint64_t depth = 0;
+        while (available > 0) {
+            size_t used = 0;
+            while (internal >= 0 && weights[internal] == depth) {
+                used++;
+                internal--;
+            }
 
-                heap.emplace_back(std::move(node));
-                std::push_heap(heap.begin(), heap.end(), heap_compare);
+            while (available > used) {
+                weights[next--] = depth;
+                available--;
             }
+
+            available = 2 * used;
+            depth++;
         }
+    }
+
+    //adds one to a code, seen as a number of code.bits bits.
+    inline void increment_code(encodedCharacter& code) {
+        for (size_t bit = code.bits; bit > 0; bit--) {
+            auto& code_byte = code.code[(bit - 1) / 8];
+            auto mask = static_cast<byte>(0x80 >> ((bit - 1) % 8));
 
-        auto node = std::make_unique<encoderTree>();
-        node->character = '\0';
-        node->frequency = 0;
-        return node;
+            code_byte ^= mask;
+            if (code_byte & mask) return;
+        }
     }
 
-    void build_encoder_table_rec(encoderTable& table, const std::unique_ptr<encoderTree>& root, encodedCharacter prefix, bool is_right_child);
+    //builds canonical codes: characters sorted by code length (then by value) get consecutive
+    //codes, each one extended with zeros to its length. all the work happens in fixed size
+    //arrays, with no heap allocation.
+    void build_encoder_table(encoderTable& table, const frequencyHistogram& frequencies) {
+        auto characters = std::array<std::pair<uint64_t, byte>, TABLE_SIZE>();
+        size_t n = 0;
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            if (frequencies[i] > 0)
+                characters[n++] = { static_cast<uint64_t>(frequencies[i]), static_cast<byte>(i) };
+        }
+        if (n == 0) return;
 
-    inline void build_encoder_table(encoderTable& table, const std::unique_ptr<encoderTree>& root) {
-        if (!root) return;
+        std::sort(characters.begin(), characters.begin() + n);
 
-        build_encoder_table_rec(table, root->left, encodedCharacter(), false);
-        build_encoder_table_rec(table, root->right, encodedCharacter(), true);
-    }
+        auto weights = std::array<uint64_t, TABLE_SIZE>();
+        for (size_t i = 0; i < n; i++)
+            weights[i] = characters[i].first;
+        compute_code_lengths(weights.data(), n);
 
-    void build_encoder_table_rec(encoderTable& table, const std::unique_ptr<encoderTree>& root, encodedCharacter prefix, bool is_right_child) {
-        if (!root) return;
+        //a lone character gets the single bit code 0 instead of an empty one,
+        //which could not be serialized or counted
+        if (n == 1) weights[0] = 1;
 
-        prefix.append_bit(is_right_child);
+        for (size_t i = 0; i < n; i++)
+            characters[i].first = weights[i];
+        std::sort(characters.begin(), characters.begin() + n);
 
-        if (root->character != '\0') {
-            table.get_mut(root->character) = prefix;
-        }
+        auto code = encodedCharacter();
+        for (size_t i = 0; i < n; i++) {
+            auto [length, character] = characters[i];
+            if (i > 0) increment_code(code);
+            while (code.bits < length)
+                code.append_bit(false);
 
-        build_encoder_table_rec(table, root->left, prefix, false);
-        build_encoder_table_rec(table, root->right, prefix, true);
+            table.get_mut(static_cast<char>(character)) = code;
+        }
     }
 }
 
@@ -90,31 +124,71 @@ namespace huffman::encoder
         }
     }
 
-    encoderTable::encoderTable(const std::unordered_map<char, int>& frequencies) {
-        auto tree = detail::build_encoder_tree(frequencies);
-        detail::build_encoder_table(*this, tree);
+    encoderTable::encoderTable(const frequencyMap& frequencies) {
+        auto histogram = frequencyHistogram();
+        histogram.fill(0);
+        for (auto const& [character, frequency] : frequencies)
+            histogram[static_cast<byte>(character)] = frequency;
+
+        detail::build_encoder_table(*this, histogram);
+    }
+
+    encoderTable::encoderTable(const frequencyHistogram& frequencies) {
+        detail::build_encoder_table(*this, frequencies);
+    }
+
+    encoderTable::encoderTable(std::vector<byte>::const_iterator& serialized, std::vector<byte>::const_iterator end)
+        : encoderTable()
+    {
+        if (serialized == end) return;
+        if (std::distance(serialized, end) < 2)
+            throw std::runtime_error("Serialized table ends before its number of characters.");
+
+        //the count takes two bytes (little endian), see serialize
+        size_t number_of_characters = serialized[0] | (serialized[1] << 8);
+        serialized += 2;
+        if (number_of_characters > TABLE_SIZE)
+            throw std::runtime_error("Serialized table has more than " + std::to_string(TABLE_SIZE) + " characters.");
+
+        for (size_t i = 0; i < number_of_characters; i++) {
+            if (std::distance(serialized, end) < 2)
+                throw std::runtime_error("Serialized table ends before all of its characters.");
+
+            auto character = serializableCharacter(serialized);
+            get_mut(character.character) = character.encoding;
+        }
     }
 
     //serialization and deserialization of the table
     std::vector<byte> encoderTable::serialize() const {
         auto serialized = std::vector<byte>();
+        serialize(serialized);
+        return serialized;
+    }
+
+    //appends the table to the given array, with the same layout of serializableCharacter,
+    //writing the bytes in place instead of building a temporary array for each character.
+    //the count takes two bytes (little endian), as a table may hold all the 256 characters.
+    void encoderTable::serialize(std::vector<byte>& out_data) const {
+        auto count_position = out_data.size();
+        out_data.push_back(0);
+        out_data.push_back(0);
 
-        byte character_count = 0;
+        uint16_t character_count = 0;
         for (size_t i = 0; i < TABLE_SIZE; i++) {
-            if (get(i).bits > 0) {
-                auto serialized_character = serializableCharacter(i, get(i)).serialize();
-                serialized.insert(
-                    std::end(serialized),
-                    std::begin(serialized_character),
-                    std::end(serialized_character)
-                );
+            auto& encoding = get(i);
+            if (encoding.bits > 0) {
+                out_data.push_back(static_cast<byte>(i));
+                out_data.push_back(encoding.bits);
+                for (size_t j = 0; j < encoding.bytes(); j++)
+                    out_data.push_back(encoding[j]);
 
                 character_count++;
             }
         }
 
-        serialized.insert(serialized.begin(), character_count);
-        return serialized;
+        out_data[count_position] = static_cast<byte>(character_count);
+        out_data[count_position + 1] = static_cast<byte>(character_count >> 8);
     }
 
     std::string encoderTable::to_string() const
@@ -1,6 +1,8 @@
 #ifndef HUFFMAN_ENCODER_TABLE
 #define HUFFMAN_ENCODER_TABLE
 
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
@@ -10,14 +12,23 @@
 
 namespace huffman::encoder
 {
+    //frequencies are 64 bit wide, as inputs may hold more than 2^31 copies of a character.
+    using frequencyMap = std::unordered_map<char, uint64_t>;
+
+    //flat histogram of character frequencies, indexed by the character's byte value.
+    using frequencyHistogram = std::array<uint64_t, TABLE_SIZE>;
+
     class encoderTable {
         private:
             encodedCharacter table[TABLE_SIZE];
 
+        public:
             encoderTable();
+            encoderTable(const frequencyMap& frequencies);
+            encoderTable(const frequencyHistogram& frequencies);
 
-        public:
-            encoderTable(const std::unordered_map<char, int>& frequencies);
+            //reads a table written by serialize, which ends at the given iterator.
+            encoderTable(std::vector<byte>::const_iterator& serialized, std::vector<byte>::const_iterator end);
 
             inline const encodedCharacter& get(char character) const {
                 return table[static_cast<byte>(character)];
@@ -32,6 +43,7 @@ namespace huffman::encoder
             }
 
             std::vector<byte> serialize() const;
+            void serialize(std::vector<byte>& out_data) const;
             std::string to_string() const;
     };
 }
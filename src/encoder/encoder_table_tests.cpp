@@ -4,12 +4,15 @@
 
 #include "serializable_character.h"
 
+#include <algorithm>
+#include <queue>
+
 using namespace huffman::encoder;
 
 void generateEncoderTable()
 {
     //frequencies for the string: this is an example of a huffman tree
-    auto frequencies = std::unordered_map<char, int>{
+    auto frequencies = frequencyMap{
         {' ', 7}, {'a', 4}, {'e', 4}, {'f', 3}, {'h', 2}, {'i', 2}, {'m', 2}, {'n', 2},
         {'s', 2}, {'t', 2}, {'l', 1}, {'o', 1}, {'p', 1}, {'r', 1}, {'u', 1}, {'x', 1},
     };
@@ -35,7 +38,7 @@ void generateEncoderTable()
 void testSerialization()
 {
     //frequencies for the string: this is an example of a huffman tree
-    auto frequencies = std::unordered_map<char, int>{
+    auto frequencies = frequencyMap{
         {' ', 7}, {'a', 4}, {'e', 4}, {'f', 3}, {'h', 2}, {'i', 2}, {'m', 2}, {'n', 2},
         {'s', 2}, {'t', 2}, {'l', 1}, {'o', 1}, {'p', 1}, {'r', 1}, {'u', 1}, {'x', 1},
     };
@@ -49,10 +52,11 @@ void testSerialization()
             valid_characters++;
     }
 
-    assert(serialized[0] == valid_characters, "Expected number \'", valid_characters, "\' as first byte,",
-        " representing the number of chracters, but found: ", std::to_string(serialized[0]));
+    auto count = serialized[0] | (serialized[1] << 8);
+    assert(count == valid_characters, "Expected number \'", valid_characters, "\' in the first two bytes,",
+        " representing the number of chracters, but found: ", count);
 
-    auto iter = serialized.cbegin(); iter++; //the first byte is the number of characters
+    auto iter = serialized.cbegin() + 2; //the first two bytes are the number of characters
     for(size_t i = 0; i < valid_characters; i++) {
         auto deserialized = serializableCharacter(iter);
         auto original_encoding = table.get(deserialized.character);
@@ -62,8 +66,123 @@ void testSerialization()
     }
 }
 
+void testSingleCharacter()
+{
+    //a table with a single character still needs a code to be serialized and decoded
+    auto frequencies = frequencyHistogram();
+    frequencies.fill(0);
+    frequencies[0] = 1000;
+    auto table = encoderTable(frequencies);
+
+    assert(table.get(0).bits == 1, "Expected a 1 bit code for the only character but found ", std::to_string(table.get(0).bits), " bits.");
+    assert(table.serialize()[0] == 1, "Expected one character in the serialized table.");
+}
+
+//the count of a full table does not wrap, and an empty table is just its count.
+void testFullAndEmptyTables()
+{
+    auto frequencies = frequencyHistogram();
+    frequencies.fill(1);
+    auto serialized = encoderTable(frequencies).serialize();
+    assert(serialized[0] == 0 && serialized[1] == 1, "Expected a count of 256 for a full table.");
+
+    auto iter = serialized.cbegin();
+    auto full = encoderTable(iter, serialized.cend());
+    assert(iter == serialized.cend(), "The full table was not read to its end.");
+    for (size_t i = 0; i < TABLE_SIZE; i++)
+        assert(full.get(i).bits == 8, "Expected an 8 bit code for character ", i, ".");
+
+    auto empty = encoderTable().serialize();
+    assert(empty.size() == 2 && empty[0] == 0 && empty[1] == 0, "Expected only a zero count for an empty table.");
+
+    iter = empty.cbegin();
+    auto deserialized = encoderTable(iter, empty.cend());
+    assert(iter == empty.cend() && deserialized.get(0).bits == 0, "The empty table was not read back as empty.");
+}
+
+//cost of an optimal code, as the sum of the weights of the internal nodes of a huffman tree.
+uint64_t optimal_bits(const frequencyHistogram& frequencies)
+{
+    auto heap = std::priority_queue<uint64_t, std::vector<uint64_t>, std::greater<uint64_t>>();
+    for (auto frequency : frequencies)
+        if (frequency > 0) heap.push(frequency);
+
+    uint64_t bits = 0;
+    while (heap.size() > 1) {
+        auto first = heap.top(); heap.pop();
+        auto second = heap.top(); heap.pop();
+        bits += first + second;
+        heap.push(first + second);
+    }
+
+    return bits;
+}
+
+void testOptimalCanonicalCodes()
+{
+    unsigned seed = 7;
+    for (size_t run = 0; run < 50; run++) {
+        auto frequencies = frequencyHistogram();
+        frequencies.fill(0);
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            seed = seed * 1103515245 + 12345;
+            if ((seed >> 16) % 4 == 0) frequencies[i] = 1 + (seed >> 8) % (1 << (run % 20));
+        }
+        frequencies[run] += 1;
+
+        auto table = encoderTable(frequencies);
+        uint64_t bits = 0;
+        for (size_t i = 0; i < TABLE_SIZE; i++)
+            bits += static_cast<uint64_t>(table.get(i).bits) * frequencies[i];
+
+        auto expected = std::max(optimal_bits(frequencies), static_cast<uint64_t>(frequencies[run]));
+        assert(bits == expected, "Expected an optimal code of ", expected, " bits but found ", bits, " bits.");
+
+        //canonical: among the codes of the same length, the ones of higher characters are greater
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            for (size_t j = i + 1; j < TABLE_SIZE; j++) {
+                auto& lower = table.get(i);
+                auto& higher = table.get(j);
+                if (lower.bits == 0 || lower.bits != higher.bits) continue;
+                assert(std::lexicographical_compare(lower.code, lower.code + lower.bytes(), higher.code, higher.code + higher.bytes()),
+                    "Codes of characters ", i, " and ", j, " are not in canonical order.");
+            }
+        }
+    }
+}
+
+void testLargeFrequencies()
+{
+    //counts above 2^32 would wrap around if they were narrowed to 32 bits anywhere
+    auto frequencies = frequencyHistogram();
+    frequencies.fill(0);
+    auto map = frequencyMap();
+    for (size_t i = 0; i < 8; i++) {
+        frequencies['a' + i] = (static_cast<uint64_t>(1) << 33) * (i + 1) + i;
+        map['a' + i] = frequencies['a' + i];
+    }
+    frequencies['z'] = 1;
+    map['z'] = 1;
+
+    auto table = encoderTable(frequencies);
+    uint64_t bits = 0;
+    for (size_t i = 0; i < TABLE_SIZE; i++)
+        bits += static_cast<uint64_t>(table.get(i).bits) * frequencies[i];
+
+    auto expected = optimal_bits(frequencies);
+    assert(bits == expected, "Expected an optimal code of ", expected, " bits but found ", bits, " bits.");
+
+    auto from_map = encoderTable(map);
+    for (size_t i = 0; i < TABLE_SIZE; i++)
+        assert(from_map.get(i) == table.get(i), "Expected the same code for character ", i, " from the map and the histogram.");
+}
+
 void testMain()
 {
     generateEncoderTable();
     testSerialization();
+    testSingleCharacter();
+    testFullAndEmptyTables();
+    testOptimalCanonicalCodes();
+    testLargeFrequencies();
 }
\ No newline at end of file
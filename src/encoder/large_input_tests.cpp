@@ -0,0 +1,70 @@
+#include "encoder.h"
+
+#include "../test_utils.h"
+
+#include "../decoder/decoder.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <thread>
+
+using namespace huffman;
+
+//the input is larger than 4 GiB and holds more than 2^31 copies of its most frequent character,
+//so that any count, offset or size narrowed to 32 bits would corrupt the output.
+constexpr size_t DEFAULT_LARGE_INPUT_SIZE = static_cast<size_t>(8) << 30;
+
+size_t large_input_size() {
+    auto size = std::getenv("HUFFMAN_LARGE_INPUT_SIZE");
+    return (size == nullptr) ? DEFAULT_LARGE_INPUT_SIZE : std::strtoull(size, nullptr, 10);
+}
+
+size_t large_input_workers() {
+    return std::max<size_t>(2, std::thread::hardware_concurrency());
+}
+
+inline char large_input_character(size_t i) {
+    return (i % 64 == 63) ? static_cast<char>('b' + (i / 64) % 8) : 'a';
+}
+
+//the text is generated again instead of being kept, to keep a single copy of it in memory
+std::string generate_large_input(size_t size) {
+    std::string text(size, '\0');
+    for (size_t i = 0; i < size; i++)
+        text[i] = large_input_character(i);
+
+    return text;
+}
+
+void assertLargeInput(const std::string& decoded, size_t size, const char* encoder) {
+    assert(decoded.size() == size, "Expected ", size, " characters from the ", encoder, " encoder, found ", decoded.size());
+    for (size_t i = 0; i < size; i++) {
+        if (decoded[i] != large_input_character(i))
+            assert(false, "Character ", i, " of the ", encoder, " encoder output differs from the input.");
+    }
+}
+
+void testParallelNative(size_t size) {
+    auto encoded = encoder::encode_parallel_native(generate_large_input(size), large_input_workers());
+    auto decoded = decoder::decode(encoded);
+    encoded = std::vector<byte>();
+
+    assertLargeInput(decoded, size, "native parallel");
+}
+
+void testParallelFastFlow(size_t size) {
+    auto encoded = encoder::encode_parallel_ff(generate_large_input(size), large_input_workers());
+    auto decoded = decoder::decode(encoded);
+    encoded = std::vector<byte>();
+
+    assertLargeInput(decoded, size, "FastFlow parallel");
+}
+
+void testMain()
+{
+    auto size = large_input_size();
+    std::cout << "Round trip of " << size << " bytes with " << large_input_workers() << " workers." << std::endl;
+
+    testParallelNative(size);
+    testParallelFastFlow(size);
+}
\ No newline at end of file
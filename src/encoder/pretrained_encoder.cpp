@@ -0,0 +1,54 @@
+#include "pretrained_encoder.h"
+
+#include "../utils.h"
+
+namespace huffman::encoder::detail
+{
+    void extract_frequencies(std::string::const_iterator, std::string::const_iterator, frequencyHistogram&);
+
+    void append_text_metadata(std::string const&, std::vector<byte>&);
+
+    void encode_text(const encoderTable&, std::string::const_iterator, std::string::const_iterator, byte, std::vector<byte>&);
+}
+
+namespace huffman::encoder
+{
+    encoderTable train_table(const std::string& corpus) {
+        auto frequencies = frequencyHistogram();
+        detail::extract_frequencies(corpus.cbegin(), corpus.cend(), frequencies);
+
+        for (auto& frequency : frequencies) {
+            if (frequency == 0) frequency = 1;
+        }
+
+        return encoderTable(frequencies);
+    }
+
+    uint64_t table_id(const std::vector<byte>& serialized_table) {
+        return fnv1a_hash(serialized_table.cbegin(), serialized_table.cend());
+    }
+
+    pretrainedEncoder::pretrainedEncoder(const encoderTable& table)
+        : serialized_table(table.serialize()), table(table), id(table_id(serialized_table)) {}
+
+    pretrainedEncoder::pretrainedEncoder(const std::vector<byte>& serialized_table)
+        : serialized_table(serialized_table), id(table_id(serialized_table))
+    {
+        auto iter = serialized_table.cbegin();
+        table = encoderTable(iter, serialized_table.cend());
+    }
+
+    void pretrainedEncoder::encode(const std::string& text, std::vector<byte>& out_data) const {
+        auto id_bytes = reinterpret_cast<const byte*>(&id);
+        out_data.insert(out_data.end(), id_bytes, id_bytes + sizeof(uint64_t));
+
+        detail::append_text_metadata(text, out_data);
+        detail::encode_text(table, text.cbegin(), text.cend(), 0, out_data);
+    }
+
+    std::vector<byte> pretrainedEncoder::encode(const std::string& text) const {
+        auto out_data = std::vector<byte>();
+        encode(text, out_data);
+        return out_data;
+    }
+}
\ No newline at end of file
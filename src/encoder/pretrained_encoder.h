@@ -0,0 +1,46 @@
+#ifndef HUFFMAN_PRETRAINED_ENCODER
+#define HUFFMAN_PRETRAINED_ENCODER
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../definitions.h"
+#include "encoder_table.h"
+
+namespace huffman::encoder
+{
+    //builds a table from a corpus of typical inputs: every character gets a code,
+    //even if it never appears in the corpus, so that any text can be encoded with it.
+    encoderTable train_table(const std::string& corpus);
+
+    //identifies a serialized table in the header of the texts encoded with it.
+    uint64_t table_id(const std::vector<byte>& serialized_table);
+
+    //a pretrainedEncoder encodes texts with a table shared with the decoder ahead of time:
+    //the output only holds the table id, the number of characters and the encoded text,
+    //and encoding is a single pass over the text.
+    class pretrainedEncoder {
+    private:
+        std::vector<byte> serialized_table;
+        encoderTable table;
+        uint64_t id;
+
+    public:
+        pretrainedEncoder(const encoderTable& table);
+        pretrainedEncoder(const std::vector<byte>& serialized_table);
+
+        inline const std::vector<byte>& serialized() const {
+            return serialized_table;
+        }
+
+        inline uint64_t get_id() const {
+            return id;
+        }
+
+        void encode(const std::string& text, std::vector<byte>& out_data) const;
+        std::vector<byte> encode(const std::string& text) const;
+    };
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "table_cache.h"
+
+#include <cmath>
+
+#include "../utils.h"
+
+namespace huffman::encoder::detail
+{
+    void extract_frequencies(std::string::const_iterator, std::string::const_iterator, frequencyHistogram&);
+
+    size_t count_bits(const encoderTable&, const frequencyHistogram&);
+
+    void append_text_metadata(std::string const&, std::vector<byte>&);
+
+    void encode_text(const encoderTable&, std::string::const_iterator, std::string::const_iterator, byte, std::vector<byte>&);
+
+    //a table can code the text only if it has a code for each of its characters.
+    bool covers(const encoderTable& table, const frequencyHistogram& frequencies) {
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            if (frequencies[i] > 0 && table.get(i).bits == 0)
+                return false;
+        }
+
+        return true;
+    }
+}
+
+namespace huffman::encoder
+{
+    double entropy_bits(const frequencyHistogram& frequencies) {
+        double total = 0;
+        for (auto frequency : frequencies)
+            total += frequency;
+
+        double bits = 0;
+        for (auto frequency : frequencies) {
+            if (frequency > 0)
+                bits += frequency * std::log2(total / frequency);
+        }
+
+        return bits;
+    }
+
+    tableCache::tableCache(size_t capacity, size_t reuse_percent)
+        : capacity(capacity == 0 ? 1 : capacity), reuse_percent(reuse_percent), hits(0), misses(0) {}
+
+    tableCache& tableCache::instance() {
+        static tableCache cache;
+        return cache;
+    }
+
+    std::shared_ptr<const cachedTable> tableCache::get(const frequencyHistogram& frequencies) {
+        //huffman codes take at least one bit per character, which is a tighter
+        //bound than the entropy for texts dominated by a single character
+        double total = 0;
+        for (auto frequency : frequencies)
+            total += frequency;
+        auto optimal_bits = std::max(entropy_bits(frequencies), total);
+        auto accepted_bits = optimal_bits * (100 + reuse_percent) / 100;
+
+        {
+            auto lock = std::lock_guard(mutex);
+            for (auto iter = entries.begin(); iter != entries.end(); iter++) {
+                auto& table = (*iter)->table;
+                if (!detail::covers(table, frequencies) || detail::count_bits(table, frequencies) > accepted_bits)
+                    continue;
+
+                //move to the front, as the most recently used
+                auto entry = *iter;
+                entries.erase(iter);
+                entries.push_front(entry);
+                hits++;
+                return entry;
+            }
+            misses++;
+        }
+
+        //build the table outside of the lock
+        auto entry = std::make_shared<cachedTable>();
+        entry->table = encoderTable(frequencies);
+        entry->table.serialize(entry->serialized);
+
+        auto lock = std::lock_guard(mutex);
+        entries.push_front(entry);
+        if (entries.size() > capacity)
+            entries.pop_back();
+
+        return entry;
+    }
+
+    size_t tableCache::get_hits() {
+        auto lock = std::lock_guard(mutex);
+        return hits;
+    }
+
+    size_t tableCache::get_misses() {
+        auto lock = std::lock_guard(mutex);
+        return misses;
+    }
+
+    void tableCache::clear() {
+        auto lock = std::lock_guard(mutex);
+        entries.clear();
+        hits = 0;
+        misses = 0;
+    }
+
+    std::vector<byte> encode_cached(const std::string& text, tableCache& cache) {
+        auto frequencies = frequencyHistogram();
+        detail::extract_frequencies(text.cbegin(), text.cend(), frequencies);
+
+        auto entry = cache.get(frequencies);
+
+        auto out_data = entry->serialized;
+        detail::append_text_metadata(text, out_data);
+        detail::encode_text(entry->table, text.cbegin(), text.cend(), 0, out_data);
+
+        return out_data;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef HUFFMAN_TABLE_CACHE
+#define HUFFMAN_TABLE_CACHE
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "../definitions.h"
+#include "encoder_table.h"
+
+namespace huffman::encoder
+{
+    //number of bits of an ideal code for the histogram: no prefix code can use less.
+    double entropy_bits(const frequencyHistogram& frequencies);
+
+    struct cachedTable {
+        encoderTable table;
+        std::vector<byte> serialized;
+    };
+
+    //a bounded, least recently used, cache of built tables: a text reuses a cached table
+    //when coding it with that table costs at most reuse_percent% more than its entropy,
+    //skipping both the tree construction and the table serialization.
+    class tableCache {
+    private:
+        std::mutex mutex;
+        std::list<std::shared_ptr<const cachedTable>> entries;
+        size_t capacity;
+        size_t reuse_percent;
+        size_t hits;
+        size_t misses;
+
+    public:
+        tableCache(size_t capacity = DEFAULT_TABLE_CACHE_SIZE, size_t reuse_percent = DEFAULT_TABLE_REUSE_PERCENT);
+        tableCache(const tableCache&) = delete;
+        tableCache& operator=(const tableCache&) = delete;
+
+        //process-wide cache, shared by all the threads.
+        static tableCache& instance();
+
+        std::shared_ptr<const cachedTable> get(const frequencyHistogram& frequencies);
+
+        size_t get_hits();
+        size_t get_misses();
+        void clear();
+    };
+
+    //same format of encode, decodable by any decoder.
+    std::vector<byte> encode_cached(const std::string& text, tableCache& cache = tableCache::instance());
+}
+
+#endif
\ No newline at end of file
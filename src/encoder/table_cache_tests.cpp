@@ -0,0 +1,55 @@
+#include "table_cache.h"
+
+#include "../test_utils.h"
+
+#include "../decoder/decoder.h"
+#include "../decoder/tree_cache.h"
+
+using namespace huffman;
+
+std::string log_line(size_t i) {
+    return "2024-05-0" + std::to_string(i % 9 + 1) + " INFO request " + std::to_string(i * 7919 % 10007) + " served in " + std::to_string(i % 97) + "ms\n";
+}
+
+void testSimilarTextsReuseTables() {
+    auto encoders = encoder::tableCache();
+    auto decoders = decoder::treeCache();
+
+    for (size_t i = 0; i < 50; i++) {
+        std::string text;
+        for (size_t j = 0; j < 20; j++)
+            text += log_line(i * 20 + j);
+
+        auto encoded = encoder::encode_cached(text, encoders);
+        assert(decoder::decode(encoded) == text, "Expected the cached table output to be a valid encoding.");
+        assert(decoder::decode_cached(encoded, decoders) == text, "Expected the cached tree to decode the text.");
+    }
+
+    assert(encoders.get_hits() > 40, "Expected most texts to reuse a table, found ", encoders.get_hits(), " hits.");
+    assert(decoders.get_hits() == encoders.get_hits(), "Expected the decoder to hit for every reused table, found ",
+        decoders.get_hits(), " hits for ", encoders.get_hits(), " reused tables.");
+}
+
+void testDifferentTextsBuildTables() {
+    auto encoders = encoder::tableCache(2);
+
+    //the second text has characters missing from the first table
+    auto first = std::string(500, 'a') + std::string(500, 'b') + std::string(500, 'c') + std::string(500, 'd');
+    auto second = std::string(1000, 'e') + std::string(10, 'a');
+    auto third = std::string(1000, 'a') + std::string(10, 'b') + std::string(10, 'c') + std::string(10, 'd');
+
+    for (auto text : {first, second, third}) {
+        auto encoded = encoder::encode_cached(text, encoders);
+        assert(decoder::decode(encoded) == text, "Round trip through the table cache failed.");
+    }
+
+    //the third text is skewed, and the two bit codes of the first table cost too much
+    assert(encoders.get_hits() == 0, "Expected no table reuse, found ", encoders.get_hits(), " hits.");
+    assert(encoders.get_misses() == 3, "Expected three tables to be built, found ", encoders.get_misses());
+}
+
+void testMain()
+{
+    testSimilarTextsReuseTables();
+    testDifferentTextsBuildTables();
+}
\ No newline at end of file
@@ -1,44 +1,162 @@
 #include "file_utils.h"
 
+#include <cerrno>
 #include <string>
 #include <filesystem>
 
-std::string read_text_file(const std::string& filename)
-{    
-    auto file = std::ifstream(filename, std::ios::in | std::ios::binary);
-    
-    if (!file.is_open()) {
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "io/io.h"
+
+static bool direct_io = false;
+
+//the whole file from offset, which is read a block at a time, many blocks in flight.
+template<class Container>
+Container read_file(const std::string& filename, size_t offset)
+{
+    struct stat status;
+    if (::stat(filename.c_str(), &status) != 0)
         throw std::runtime_error("File \"" + filename + "\" does not exist.");
+
+    size_t file_size = status.st_size;
+    bool direct = direct_io && file_size >= DEFAULT_DIRECT_IO_SIZE;
+    auto file = fileDescriptor{ ::open(filename.c_str(), O_RDONLY | (direct ? O_DIRECT : 0)) };
+
+    //some file systems (tmpfs) do not support O_DIRECT
+    if (file.fd < 0 && direct) {
+        direct = false;
+        file.fd = ::open(filename.c_str(), O_RDONLY);
     }
 
-    auto file_size = std::filesystem::file_size(filename);
-    std::string out(file_size, '\0');
-    file.read(out.data(), file_size);
+    if (file.fd < 0)
+        throw std::runtime_error("File \"" + filename + "\" does not exist.");
+
+    if (file_size <= offset)
+        return Container();
 
-    return out;
+    Container result(file_size - offset, 0);
+    auto data = reinterpret_cast<unsigned char*>(result.data());
+    result.resize(huffman::io::read_at(file.fd, data, result.size(), offset, huffman::io::default_backend(), direct));
+
+    return result;
 }
 
-std::vector<unsigned char> read_binary_file(const std::string& filename)
+//the size of a pipe is not known in advance, so it is read in chunks until its end.
+template<class Container>
+Container read_until_end(std::istream& input)
 {
-    auto file = std::ifstream(filename, std::ios::binary);
-    file.exceptions(std::ios_base::badbit);
+    constexpr size_t CHUNK_SIZE = 1 << 20;
 
-    if (!file.is_open()) {
-        throw std::runtime_error("File \"" + filename + "\" does not exist.");
+    Container result;
+    while (input) {
+        auto start = result.size();
+        result.resize(start + CHUNK_SIZE);
+        input.read(reinterpret_cast<char*>(result.data() + start), CHUNK_SIZE);
+        result.resize(start + input.gcount());
     }
 
-    auto file_size = std::filesystem::file_size(filename);
-    if (file_size == 0) {
-        return std::vector<unsigned char>{};
-    }
+    return result;
+}
 
-    std::vector<unsigned char> result(file_size);
-    file.read(reinterpret_cast<char*>(result.data()), file_size);
+bool is_standard_stream(const std::string& filename)
+{
+    return filename == "-";
+}
 
-    return result;
+std::string read_text_file(const std::string& filename)
+{    
+    if (is_standard_stream(filename))
+        return read_until_end<std::string>(std::cin);
+
+    return read_file<std::string>(filename, 0);
+}
+
+std::vector<unsigned char> read_binary_file(const std::string& filename, size_t offset)
+{
+    return read_file<std::vector<unsigned char>>(filename, offset);
+}
+
+std::vector<unsigned char> read_remaining(std::istream& input)
+{
+    return read_until_end<std::vector<unsigned char>>(input);
+}
+
+void write_binary_file(const std::string& filename, const void* data, size_t size, bool overwrite)
+{
+    auto file = fileDescriptor{ open_output_file(filename, overwrite) };
+    huffman::io::write_at(file.fd, static_cast<const unsigned char*>(data), size, 0, huffman::io::default_backend());
+}
+
+int open_output_file(const std::string& filename, bool overwrite)
+{
+    auto fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | (overwrite ? O_TRUNC : O_EXCL), 0644);
+    if (fd < 0 && errno == EEXIST)
+        throw std::runtime_error("Output file \"" + filename + "\" already exists.");
+    if (fd < 0)
+        throw std::runtime_error("Could not open \"" + filename + "\".");
+
+    return fd;
+}
+
+fileDescriptor::~fileDescriptor()
+{
+    if (fd >= 0) ::close(fd);
+}
+
+void set_direct_io(bool enabled)
+{
+    direct_io = enabled;
 }
 
 bool file_exists(const std::string& filename) {
     auto file = std::ifstream(filename, std::ios::binary);
     return file.is_open();
+}
+
+std::streamsize read_available(std::istream& input, char* data, std::streamsize size) {
+    if (size <= 0 || !input.read(data, 1)) return 0;
+
+    return 1 + input.readsome(data + 1, size - 1);
+}
+
+descriptorBuffer::descriptorBuffer(int fd)
+    : fd(fd), buffer(1 << 16) {}
+
+descriptorBuffer::int_type descriptorBuffer::underflow() {
+    if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+
+    ssize_t count;
+    do {
+        count = ::read(fd, buffer.data(), buffer.size());
+    } while (count < 0 && errno == EINTR);
+
+    if (count <= 0) return traits_type::eof();
+
+    setg(buffer.data(), buffer.data(), buffer.data() + count);
+    return traits_type::to_int_type(*gptr());
+}
+
+//only the buffered bytes are known to be available without waiting
+std::streamsize descriptorBuffer::showmanyc() {
+    return 0;
+}
+
+inputStream::inputStream(const std::string& filename)
+    : standard_input_buffer(STDIN_FILENO), standard_input(&standard_input_buffer), stream(&standard_input)
+{
+    if (!is_standard_stream(filename)) {
+        file.open(filename, std::ios::binary);
+        stream = &file;
+    }
+}
+
+outputStream::outputStream(const std::string& filename)
+    : stream(&std::cout)
+{
+    if (!is_standard_stream(filename)) {
+        file.open(filename, std::ios::binary);
+        stream = &file;
+    }
 }
\ No newline at end of file
@@ -7,8 +7,81 @@
 #include <limits>
 #include <vector>
 
+//"-" names the standard input as an input file, and the standard output as an output file.
+bool is_standard_stream(const std::string& filename);
+
 std::string read_text_file(const std::string& filename);
-std::vector<unsigned char> read_binary_file(const std::string& filename);
+std::vector<unsigned char> read_binary_file(const std::string& filename, size_t offset = 0);
+std::vector<unsigned char> read_remaining(std::istream& input);
 bool file_exists(const std::string& filename);
 
+//files are read and written through io_uring where it is available, with pread and pwrite otherwise.
+//without overwrite, the file must not exist: it is created atomically, and the call fails otherwise.
+void write_binary_file(const std::string& filename, const void* data, size_t size, bool overwrite = true);
+
+//the file created (or truncated) for writing; the descriptor is to be closed by a fileDescriptor.
+int open_output_file(const std::string& filename, bool overwrite = true);
+
+//closes the file descriptor when it goes out of scope.
+struct fileDescriptor {
+    int fd;
+
+    ~fileDescriptor();
+};
+
+//files of at least DEFAULT_DIRECT_IO_SIZE bytes are then read with O_DIRECT, bypassing the page cache.
+void set_direct_io(bool enabled);
+
+//reads at least one byte, waiting for it, and then only the bytes which are already available:
+//on a pipe or a socket the data is returned as it arrives instead of once size bytes are read.
+std::streamsize read_available(std::istream& input, char* data, std::streamsize size);
+
+//a stream buffer over a file descriptor, which is filled by a single read each time: unlike
+//std::cin, whose reads wait for the whole request, it hands out what the descriptor had.
+class descriptorBuffer : public std::streambuf {
+private:
+    int fd;
+    std::vector<char> buffer;
+
+protected:
+    int_type underflow() override;
+    std::streamsize showmanyc() override;
+
+public:
+    descriptorBuffer(int fd);
+};
+
+//the file opened in binary mode, or the standard input for "-".
+class inputStream {
+private:
+    std::ifstream file;
+    descriptorBuffer standard_input_buffer;
+    std::istream standard_input;
+    std::istream* stream;
+
+public:
+    inputStream(const std::string& filename);
+    inputStream(const inputStream&) = delete;
+    inputStream& operator=(const inputStream&) = delete;
+
+    inline std::istream& operator*() {
+        return *stream;
+    }
+};
+
+class outputStream {
+private:
+    std::ofstream file;
+    std::ostream* stream;
+
+public:
+    outputStream(const std::string& filename);
+    outputStream(const outputStream&) = delete;
+    outputStream& operator=(const outputStream&) = delete;
+
+    inline std::ostream& operator*() {
+        return *stream;
+    }
+};
+
 #endif
\ No newline at end of file
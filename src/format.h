@@ -0,0 +1,49 @@
+#ifndef FORMAT
+#define FORMAT
+
+#include "definitions.h"
+
+namespace huffman
+{
+    //the first byte of an encoded file tells which engine produced it.
+    enum class formatTag : byte {
+        huffman = 'H',
+        adaptive = 'A',
+        interleaved = 'I',
+        tans = 'T',
+        blocks = 'B',
+        pretrained = 'P'
+    };
+
+    //a block file is a sequence of [type][raw size][payload size][payload], closed by an end block.
+    //repeat blocks are coded with the table of the last huffman block before them.
+    enum class blockType : byte {
+        end = 0,
+        huffman = 1,
+        stored = 2,
+        constant = 3,
+        packed = 4,
+        repeat = 5
+    };
+
+    //packed blocks code each character as its index in a list of at most 16 characters.
+    constexpr size_t MAX_PACKED_CHARACTERS = 16;
+
+    inline size_t packed_width(size_t characters) {
+        return (characters <= 2) ? 1 : (characters <= 4) ? 2 : 4;
+    }
+
+    //type byte and two 8 byte sizes.
+    constexpr size_t BLOCK_HEADER_SIZE = 1 + 2 * sizeof(size_t);
+
+    inline bool is_format_tag(int value) {
+        return value == static_cast<byte>(formatTag::huffman)
+            || value == static_cast<byte>(formatTag::adaptive)
+            || value == static_cast<byte>(formatTag::interleaved)
+            || value == static_cast<byte>(formatTag::tans)
+            || value == static_cast<byte>(formatTag::blocks)
+            || value == static_cast<byte>(formatTag::pretrained);
+    }
+}
+
+#endif
\ No newline at end of file
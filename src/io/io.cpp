@@ -0,0 +1,392 @@
+#include "io.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+namespace huffman::io::detail
+{
+    //alignment of the buffers, offsets and sizes of direct reads
+    constexpr size_t DIRECT_ALIGNMENT = 4096;
+
+    std::runtime_error io_error(const std::string& operation, int error) {
+        return std::runtime_error(operation + " failed: " + std::strerror(error));
+    }
+
+    //a block of a read or a write, resubmitted from where it stopped when it completes short.
+    struct ioBlock {
+        uint64_t offset;
+        size_t size;
+        size_t done;
+        unsigned buffer;
+    };
+
+    //memory aligned for direct reads, which the kernel copies to without going through the page cache.
+    struct alignedBuffer {
+        byte* data;
+
+        alignedBuffer(size_t size)
+            : data(static_cast<byte*>(std::aligned_alloc(DIRECT_ALIGNMENT, size)))
+        {
+            if (data == nullptr) throw std::bad_alloc();
+        }
+
+        ~alignedBuffer() {
+            std::free(data);
+        }
+
+        alignedBuffer(const alignedBuffer&) = delete;
+        alignedBuffer& operator=(const alignedBuffer&) = delete;
+    };
+
+    //an io_uring set up through the system calls themselves, so that liburing is not needed.
+    class ioRing {
+    private:
+        int ring_fd;
+        unsigned entries;
+        unsigned queued;
+
+        void* sq_ring;
+        size_t sq_ring_size;
+        void* cq_ring;
+        size_t cq_ring_size;
+        io_uring_sqe* sqes;
+        size_t sqes_size;
+
+        unsigned* sq_tail;
+        unsigned* sq_mask;
+        unsigned* sq_array;
+        unsigned* cq_head;
+        unsigned* cq_tail;
+        unsigned* cq_mask;
+        io_uring_cqe* cqes;
+
+        //one IO_BLOCK_SIZE buffer per entry for the direct reads, allocated and registered
+        //with the kernel on the first one, so that it does not pin the pages at every read.
+        std::unique_ptr<alignedBuffer> buffers;
+        bool registered;
+
+        void unmap() {
+            if (sqes != MAP_FAILED) munmap(sqes, sqes_size);
+            if (cq_ring != MAP_FAILED && cq_ring != sq_ring) munmap(cq_ring, cq_ring_size);
+            if (sq_ring != MAP_FAILED) munmap(sq_ring, sq_ring_size);
+            ::close(ring_fd);
+        }
+
+    public:
+        ioRing(unsigned entries)
+            : queued(0), sq_ring(MAP_FAILED), cq_ring(MAP_FAILED), sqes(static_cast<io_uring_sqe*>(MAP_FAILED)), registered(false)
+        {
+            auto parameters = io_uring_params();
+            ring_fd = syscall(__NR_io_uring_setup, entries, &parameters);
+            if (ring_fd < 0)
+                throw io_error("io_uring setup", errno);
+
+            this->entries = parameters.sq_entries;
+            sq_ring_size = parameters.sq_off.array + parameters.sq_entries * sizeof(unsigned);
+            cq_ring_size = parameters.cq_off.cqes + parameters.cq_entries * sizeof(io_uring_cqe);
+            sqes_size = parameters.sq_entries * sizeof(io_uring_sqe);
+
+            //recent kernels map both rings at once
+            bool single_map = parameters.features & IORING_FEAT_SINGLE_MMAP;
+            if (single_map)
+                sq_ring_size = cq_ring_size = std::max(sq_ring_size, cq_ring_size);
+
+            sq_ring = mmap(nullptr, sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+            cq_ring = single_map ? sq_ring
+                : mmap(nullptr, cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+            if (sq_ring != MAP_FAILED && cq_ring != MAP_FAILED)
+                sqes = static_cast<io_uring_sqe*>(mmap(nullptr, sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES));
+
+            if (sqes == MAP_FAILED) {
+                auto error = errno;
+                unmap();
+                throw io_error("io_uring mmap", error);
+            }
+
+            auto sq = static_cast<byte*>(sq_ring);
+            sq_tail = reinterpret_cast<unsigned*>(sq + parameters.sq_off.tail);
+            sq_mask = reinterpret_cast<unsigned*>(sq + parameters.sq_off.ring_mask);
+            sq_array = reinterpret_cast<unsigned*>(sq + parameters.sq_off.array);
+
+            auto cq = static_cast<byte*>(cq_ring);
+            cq_head = reinterpret_cast<unsigned*>(cq + parameters.cq_off.head);
+            cq_tail = reinterpret_cast<unsigned*>(cq + parameters.cq_off.tail);
+            cq_mask = reinterpret_cast<unsigned*>(cq + parameters.cq_off.ring_mask);
+            cqes = reinterpret_cast<io_uring_cqe*>(cq + parameters.cq_off.cqes);
+        }
+
+        ~ioRing() {
+            unmap();
+        }
+
+        ioRing(const ioRing&) = delete;
+        ioRing& operator=(const ioRing&) = delete;
+
+        inline unsigned depth() const {
+            return entries;
+        }
+
+        byte* buffer(unsigned index) {
+            if (!buffers) {
+                buffers = std::make_unique<alignedBuffer>(entries * IO_BLOCK_SIZE);
+
+                //without the memlock limit to pin them the buffers still work, unregistered
+                std::vector<iovec> iovecs(entries);
+                for (unsigned i = 0; i < entries; i++)
+                    iovecs[i] = { buffers->data + i * IO_BLOCK_SIZE, IO_BLOCK_SIZE };
+                registered = syscall(__NR_io_uring_register, ring_fd, IORING_REGISTER_BUFFERS, iovecs.data(), entries) == 0;
+            }
+
+            return buffers->data + index * IO_BLOCK_SIZE;
+        }
+
+        //queues a read or write of a buffer or, for a direct read, of the registered buffer of the given index.
+        void push(uint8_t opcode, int fd, byte* data, size_t size, uint64_t offset, uint64_t user_data, int buffer_index = -1) {
+            auto tail = *sq_tail;
+            auto index = tail & *sq_mask;
+
+            auto& sqe = sqes[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = opcode;
+            sqe.fd = fd;
+            sqe.addr = reinterpret_cast<uint64_t>(data);
+            sqe.len = size;
+            sqe.off = offset;
+            sqe.user_data = user_data;
+            if (buffer_index >= 0 && registered) {
+                sqe.opcode = IORING_OP_READ_FIXED;
+                sqe.buf_index = buffer_index;
+            }
+
+            sq_array[index] = index;
+            __atomic_store_n(sq_tail, tail + 1, __ATOMIC_RELEASE);
+            queued++;
+        }
+
+        //submits the queued entries and waits for at least one of them to complete.
+        void submit_and_wait() {
+            while (true) {
+                auto submitted = syscall(__NR_io_uring_enter, ring_fd, queued, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                if (submitted >= 0) {
+                    queued -= submitted;
+                    return;
+                }
+                if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+                    throw io_error("io_uring submission", errno);
+            }
+        }
+
+        //calls handle(user data, result) on every completed entry.
+        template<class Handler>
+        void reap(Handler handle) {
+            auto head = *cq_head;
+            auto tail = __atomic_load_n(cq_tail, __ATOMIC_ACQUIRE);
+
+            for (; head != tail; head++) {
+                auto& cqe = cqes[head & *cq_mask];
+                handle(cqe.user_data, cqe.res);
+            }
+
+            __atomic_store_n(cq_head, head, __ATOMIC_RELEASE);
+        }
+    };
+
+    //one ring per thread, set up on its first use; null where io_uring is not available.
+    ioRing* thread_ring() {
+        thread_local auto ring = std::unique_ptr<ioRing>();
+        thread_local bool failed = false;
+
+        if (!ring && !failed) {
+            try {
+                ring = std::make_unique<ioRing>(IO_QUEUE_DEPTH);
+            } catch (const std::exception&) {
+                failed = true;
+            }
+        }
+
+        return ring.get();
+    }
+
+    std::vector<ioBlock> split_blocks(uint64_t start, uint64_t end) {
+        std::vector<ioBlock> blocks;
+        for (auto offset = start; offset < end; offset += IO_BLOCK_SIZE)
+            blocks.push_back({ offset, std::min<size_t>(IO_BLOCK_SIZE, end - offset), 0, 0 });
+
+        return blocks;
+    }
+
+    //copies the part of a block read at block_offset which lies in [offset, offset + size) to data.
+    void copy_overlap(const byte* block, uint64_t block_offset, size_t block_size, byte* data, uint64_t offset, size_t size) {
+        auto start = std::max(block_offset, offset);
+        auto end = std::min(block_offset + block_size, offset + size);
+        if (start < end)
+            std::memcpy(data + (start - offset), block + (start - block_offset), end - start);
+    }
+
+    //keeps up to the depth of the ring of blocks in flight, and resubmits the short ones. After an error
+    //the blocks in flight are waited for, as the kernel may still be using their buffers.
+    size_t uring_transfer(ioRing& ring, uint8_t opcode, int fd, byte* data, size_t size, uint64_t offset) {
+        auto blocks = split_blocks(offset, offset + size);
+        auto end = offset + size;
+        size_t next = 0;
+        unsigned in_flight = 0;
+        int error = 0;
+
+        auto submit = [&](size_t i) {
+            auto& block = blocks[i];
+            ring.push(opcode, fd, data + (block.offset - offset) + block.done, block.size - block.done, block.offset + block.done, i);
+            in_flight++;
+        };
+
+        while (in_flight > 0 || (next < blocks.size() && error == 0)) {
+            while (next < blocks.size() && in_flight < ring.depth() && error == 0)
+                submit(next++);
+
+            ring.submit_and_wait();
+            ring.reap([&](uint64_t i, int result) {
+                auto& block = blocks[i];
+                in_flight--;
+
+                if (result == -EINTR || result == -EAGAIN) {
+                    if (error == 0) submit(i);
+                } else if (result < 0) {
+                    error = -result;
+                } else if (result == 0) {
+                    //the end of the file, for a read
+                    if (opcode == IORING_OP_WRITE) error = EIO;
+                    end = std::min(end, block.offset + block.done);
+                } else if ((block.done += result) < block.size && error == 0) {
+                    submit(i);
+                }
+            });
+        }
+
+        if (error != 0)
+            throw io_error(opcode == IORING_OP_WRITE ? "io_uring write" : "io_uring read", error);
+
+        return end - offset;
+    }
+
+    //direct reads go through the aligned buffers of the ring, a block per buffer, and are copied from there.
+    size_t uring_read_direct(ioRing& ring, int fd, byte* data, size_t size, uint64_t offset) {
+        auto aligned_start = offset / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+        auto aligned_end = (offset + size + DIRECT_ALIGNMENT - 1) / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+        auto blocks = split_blocks(aligned_start, aligned_end);
+        auto end = offset + size;
+        size_t next = 0;
+        int error = 0;
+
+        std::vector<unsigned> free_buffers;
+        for (unsigned i = ring.depth(); i > 0; i--)
+            free_buffers.push_back(i - 1);
+
+        while (free_buffers.size() < ring.depth() || (next < blocks.size() && error == 0)) {
+            while (next < blocks.size() && !free_buffers.empty() && error == 0) {
+                auto& block = blocks[next];
+                block.buffer = free_buffers.back();
+                free_buffers.pop_back();
+                ring.push(IORING_OP_READ, fd, ring.buffer(block.buffer), block.size, block.offset, next++, block.buffer);
+            }
+
+            ring.submit_and_wait();
+            ring.reap([&](uint64_t i, int result) {
+                auto& block = blocks[i];
+                free_buffers.push_back(block.buffer);
+
+                if (result < 0) {
+                    error = -result;
+                    return;
+                }
+
+                //a direct read is only short at the end of the file
+                copy_overlap(ring.buffer(block.buffer), block.offset, result, data, offset, size);
+                if (static_cast<size_t>(result) < block.size)
+                    end = std::min(end, std::max(offset, block.offset + result));
+            });
+        }
+
+        if (error != 0)
+            throw io_error("io_uring direct read", error);
+
+        return end - offset;
+    }
+
+    size_t pread_read(int fd, byte* data, size_t size, uint64_t offset) {
+        size_t done = 0;
+        while (done < size) {
+            auto result = ::pread(fd, data + done, size - done, offset + done);
+            if (result < 0 && errno == EINTR) continue;
+            if (result < 0) throw io_error("pread", errno);
+            if (result == 0) break;
+            done += result;
+        }
+
+        return done;
+    }
+
+    //block by block through an aligned buffer, as a direct read cannot go to data itself.
+    size_t pread_read_direct(int fd, byte* data, size_t size, uint64_t offset) {
+        auto buffer = alignedBuffer(IO_BLOCK_SIZE);
+        auto aligned_start = offset / DIRECT_ALIGNMENT * DIRECT_ALIGNMENT;
+
+        for (auto block_offset = aligned_start; block_offset < offset + size; block_offset += IO_BLOCK_SIZE) {
+            auto result = pread_read(fd, buffer.data, IO_BLOCK_SIZE, block_offset);
+            copy_overlap(buffer.data, block_offset, result, data, offset, size);
+            if (result < IO_BLOCK_SIZE)
+                return std::max(offset, block_offset + result) - offset;
+        }
+
+        return size;
+    }
+
+    void pwrite_write(int fd, const byte* data, size_t size, uint64_t offset) {
+        size_t done = 0;
+        while (done < size) {
+            auto result = ::pwrite(fd, data + done, size - done, offset + done);
+            if (result < 0 && errno == EINTR) continue;
+            if (result <= 0) throw io_error("pwrite", result < 0 ? errno : EIO);
+            done += result;
+        }
+    }
+}
+
+namespace huffman::io
+{
+    ioBackend default_backend() {
+        static auto backend = (detail::thread_ring() != nullptr) ? ioBackend::uring : ioBackend::pread;
+        return backend;
+    }
+
+    size_t read_at(int fd, byte* data, size_t size, uint64_t offset, ioBackend backend, bool direct) {
+        //a single block gains nothing from a queue
+        auto ring = (backend == ioBackend::uring && (direct || size > IO_BLOCK_SIZE)) ? detail::thread_ring() : nullptr;
+
+        if (ring == nullptr)
+            return direct ? detail::pread_read_direct(fd, data, size, offset) : detail::pread_read(fd, data, size, offset);
+
+        return direct ? detail::uring_read_direct(*ring, fd, data, size, offset)
+            : detail::uring_transfer(*ring, IORING_OP_READ, fd, data, size, offset);
+    }
+
+    void write_at(int fd, const byte* data, size_t size, uint64_t offset, ioBackend backend) {
+        auto ring = (backend == ioBackend::uring && size > IO_BLOCK_SIZE) ? detail::thread_ring() : nullptr;
+
+        if (ring == nullptr) {
+            detail::pwrite_write(fd, data, size, offset);
+        } else {
+            detail::uring_transfer(*ring, IORING_OP_WRITE, fd, const_cast<byte*>(data), size, offset);
+        }
+    }
+}
\ No newline at end of file
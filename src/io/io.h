@@ -0,0 +1,30 @@
+#ifndef HUFFMAN_IO
+#define HUFFMAN_IO
+
+#include <cstdint>
+#include <cstddef>
+
+#include "../definitions.h"
+
+namespace huffman::io
+{
+    enum class ioBackend {
+        //up to IO_QUEUE_DEPTH blocks of IO_BLOCK_SIZE bytes in flight through an io_uring
+        uring,
+        //one blocking pread or pwrite at a time
+        pread
+    };
+
+    //io_uring where the kernel (or the sandbox) allows it, pread and pwrite otherwise.
+    ioBackend default_backend();
+
+    //reads up to size bytes at offset of the file into data, and returns the number of bytes read,
+    //which is less than size only at the end of the file. A direct read (of a file opened with
+    //O_DIRECT) goes through aligned registered buffers, so data and offset need no alignment.
+    size_t read_at(int fd, byte* data, size_t size, uint64_t offset, ioBackend backend, bool direct = false);
+
+    //writes the size bytes of data at offset of the file.
+    void write_at(int fd, const byte* data, size_t size, uint64_t offset, ioBackend backend);
+}
+
+#endif
\ No newline at end of file
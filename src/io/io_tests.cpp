@@ -0,0 +1,70 @@
+#include "io.h"
+
+#include "../test_utils.h"
+
+#include "../file_utils.h"
+
+#include <filesystem>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace huffman;
+
+std::vector<byte> io_bytes(size_t size) {
+    std::vector<byte> bytes(size);
+    for (size_t i = 0; i < size; i++)
+        bytes[i] = static_cast<byte>(i * 2654435761u >> 13);
+
+    return bytes;
+}
+
+//more blocks than the depth of the queue, and a last block which is not full.
+void testRoundTrip(io::ioBackend backend, const std::string& filename) {
+    auto bytes = io_bytes(IO_QUEUE_DEPTH * IO_BLOCK_SIZE + 3 * IO_BLOCK_SIZE + 12345);
+
+    auto fd = ::open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0, "Could not create ", filename);
+    io::write_at(fd, bytes.data(), bytes.size(), 0, backend);
+
+    for (bool direct : { false, true }) {
+        std::vector<byte> read(bytes.size());
+        auto size = io::read_at(fd, read.data(), read.size(), 0, backend, direct);
+        assert(size == bytes.size() && read == bytes, "Expected the whole file to be read back, direct: ", direct);
+
+        //unaligned, and past the end of the file
+        auto offset = IO_BLOCK_SIZE + 7;
+        std::vector<byte> tail(bytes.size());
+        size = io::read_at(fd, tail.data(), tail.size(), offset, backend, direct);
+        assert(size == bytes.size() - offset, "Expected the read to stop at the end of the file, read ", size, " bytes.");
+        assert(std::equal(tail.begin(), tail.begin() + size, bytes.begin() + offset), "Expected the end of the file from the offset.");
+    }
+
+    ::close(fd);
+    std::filesystem::remove(filename);
+}
+
+void testFileUtils(const std::string& filename) {
+    auto bytes = io_bytes(5 * IO_BLOCK_SIZE + 1);
+    write_binary_file(filename, bytes.data(), bytes.size());
+
+    assert(read_binary_file(filename) == bytes, "Expected the written file to be read back.");
+    assert(read_binary_file(filename, 1).size() == bytes.size() - 1, "Expected the offset to be skipped.");
+    assert(read_text_file(filename).size() == bytes.size(), "Expected the text file to be read as a whole.");
+
+    //shorter than the previous contents
+    write_binary_file(filename, bytes.data(), 10);
+    assert(read_binary_file(filename).size() == 10, "Expected the file to be truncated.");
+
+    std::filesystem::remove(filename);
+}
+
+void testMain()
+{
+    auto filename = (std::filesystem::temp_directory_path() / "huffman_io_tests").string();
+
+    testRoundTrip(io::ioBackend::pread, filename);
+    testRoundTrip(io::default_backend(), filename);
+    testFileUtils(filename);
+}
\ No newline at end of file
@@ -1,82 +1,275 @@
 #include <cstdio>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
 #include <limits>
 
 #include "file_utils.h"
 #include "cmd_args.h"
+#include "format.h"
 
 #include "encoder/encoder.h"
 #include "decoder/decoder.h"
+#include "encoder/pretrained_encoder.h"
+#include "decoder/pretrained_decoder.h"
+#include "adaptive/adaptive.h"
+#include "tans/tans.h"
+#include "batch/batch.h"
+#include "service/service.h"
+#include "io/io.h"
 
-#ifdef CHRONO_ENABLED
 #include "timing.h"
-#endif
 
 using namespace huffman;
 
-int main(int argc, char** argv)
+formatTag format_of(programMode mode) {
+    switch (mode) {
+        case programMode::encodeAdaptive:
+            return formatTag::adaptive;
+        case programMode::encodeInterleaved:
+            return formatTag::interleaved;
+        case programMode::encodeTans:
+        case programMode::encodeTansParallelNative:
+        case programMode::encodeTansParallelFastFlow:
+            return formatTag::tans;
+        case programMode::encodeBlocks:
+        case programMode::encodeBlocksParallelFastFlow:
+            return formatTag::blocks;
+        case programMode::encodePretrained:
+            return formatTag::pretrained;
+        default:
+            return formatTag::huffman;
+    }
+}
+
+int run(const programOptions& options)
 {
-    auto programOptions = parse_arguments(argc, argv);
-    if (!programOptions.has_value()) {
-        return 1;
+    if (options.encode == programMode::encodeBatch || options.encode == programMode::decodeBatch) {
+        auto input_files = batch::expand_inputs(options.input_file);
+        if (input_files.empty()) {
+            printf("No input file matches %s.\n", options.input_file.c_str());
+            return 1;
+        }
+
+        auto report = batch::run_batch(input_files, options.output_file, options.encode == programMode::encodeBatch, options.number_of_workers, options.overwrite_output);
+        for (auto& error : report.errors)
+            printf("%s\n", error.c_str());
+
+        printf("%zu files (%zu failed), %zu bytes read and %zu bytes written in %.3f s (%.1f MB/s).\n",
+            report.files, report.failed, report.input_bytes, report.output_bytes, report.seconds,
+            (report.seconds > 0) ? report.input_bytes / report.seconds / 1e6 : 0.0);
+        return (report.failed == 0) ? 0 : 1;
     }
 
-    auto options = programOptions.value();
-    if (file_exists(options.output_file) && !options.overwrite_output) {
+    if (options.encode == programMode::serve) {
+        auto backend = options.fastflow ? encoder::contextBackend::fastflow : encoder::contextBackend::native;
+        auto server = service::jobServer(options.socket_file, options.number_of_workers, backend);
+        server.serve();
+        return 0;
+    } else if (options.encode == programMode::stopServer) {
+        service::submit(options.socket_file, { service::jobCommand::stop, "", "", {} });
+        return 0;
+    }
+
+    if (!is_standard_stream(options.output_file) && file_exists(options.output_file) && !options.overwrite_output) {
         printf("Output file %s already exists. You may force overwrite if you wish.", options.output_file.c_str());
         return 1;
     }
 
-    if (options.encode == programMode::decode) {
-        auto encoded_text = read_binary_file(options.input_file);
-        auto text = decoder::decode(encoded_text);
+    if (!options.socket_file.empty()) {
+        //the daemon opens the files itself, the standard streams are sent inline
+        auto command = (options.encode == programMode::encode) ? service::jobCommand::encode : service::jobCommand::decode;
+        auto request = service::jobRequest{ command, "", "", {} };
+        if (is_standard_stream(options.input_file)) {
+            request.payload = read_remaining(std::cin);
+        } else {
+            request.input_file = std::filesystem::absolute(options.input_file).string();
+        }
+        if (!is_standard_stream(options.output_file))
+            request.output_file = std::filesystem::absolute(options.output_file).string();
+
+        auto response = service::submit(options.socket_file, request);
+        if (!response.ok) {
+            fprintf(stderr, "Job failed: %s\n", std::string(response.payload.begin(), response.payload.end()).c_str());
+            return 1;
+        }
+
+        std::cout.write(reinterpret_cast<char*>(response.payload.data()), response.payload.size());
+        std::cout.flush();
+        fprintf(stderr, "Job completed in %llu us (%llu us coding).\n",
+            static_cast<unsigned long long>(response.total_microseconds), static_cast<unsigned long long>(response.coding_microseconds));
+        return 0;
+    }
+
+    if (options.encode == programMode::train) {
+        //the table file is the serialized table, its hash is the id written by the encoder
+        auto corpus = read_text_file(options.input_file);
+        auto table = encoder::train_table(corpus).serialize();
+
+        auto file = std::ofstream(options.output_file, std::ios::binary);
+        file.write(reinterpret_cast<char*>(table.data()), table.size());
+    } else if (options.encode == programMode::decode) {
+        auto input = inputStream(options.input_file);
+        auto tag = (*input).get();
+        if (!is_format_tag(tag)) {
+            fprintf(stderr, "Input file %s is not an encoded file.\n", options.input_file.c_str());
+            return 1;
+        }
+
+        //everything but the tag, which has already been read
+        auto read_encoded_text = [&]() {
+            return is_standard_stream(options.input_file) ? read_remaining(*input) : read_binary_file(options.input_file, 1);
+        };
+
+        auto output = outputStream(options.output_file);
+        auto& file = *output;
+        if (tag == static_cast<byte>(formatTag::adaptive)) {
+            adaptive::decode_stream(*input, file);
+        } else if (tag == static_cast<byte>(formatTag::interleaved)) {
+            auto encoded_text = read_encoded_text();
+            auto text = decoder::decode_interleaved(encoded_text);
+            file << text << std::flush;
+        } else if (tag == static_cast<byte>(formatTag::blocks)) {
+            //one block at a time, the input and output may be pipes
+            decoder::decode_blocks(*input, file);
+        } else if (tag == static_cast<byte>(formatTag::pretrained)) {
+            if (options.table_file.empty()) {
+                fprintf(stderr, "Input file %s was encoded with a pretrained table, which must be given with --table.\n", options.input_file.c_str());
+                return 1;
+            }
+
+            auto decoder = decoder::pretrainedDecoder(read_binary_file(options.table_file));
+            auto encoded_text = read_encoded_text();
+            auto text = decoder.decode(encoded_text);
+            file << text << std::flush;
+        } else if (tag == static_cast<byte>(formatTag::tans)) {
+            auto encoded_text = read_encoded_text();
+            auto text = tans::decode(encoded_text, options.number_of_workers);
+            file << text << std::flush;
+        } else {
+            auto encoded_text = read_encoded_text();
+            auto text = decoder::decode(encoded_text);
+            file << text << std::flush;
+        }
+    } else if (options.encode == programMode::encodeAdaptive) {
+        //one pass, the input is never held in memory as a whole
+        auto input = inputStream(options.input_file);
+        auto output = outputStream(options.output_file);
+        (*output).put(static_cast<char>(format_of(options.encode)));
+        adaptive::encode_stream(*input, *output);
+    } else if (options.encode == programMode::encodeBlocks || options.encode == programMode::encodeBlocksParallelFastFlow) {
+        auto timer = TimingScope("main");
+
+        //reading, encoding and writing overlap, block by block
+        auto input = inputStream(options.input_file);
+        auto output = outputStream(options.output_file);
+        (*output).put(static_cast<char>(format_of(options.encode)));
+        if (options.encode == programMode::encodeBlocks) {
+            encoder::encode_blocks(*input, *output, options.number_of_workers, options.block_size, options.min_saving_percent);
+        } else {
+            encoder::encode_blocks_ff(*input, *output, options.number_of_workers, options.block_size, options.min_saving_percent);
+        }
 
-        auto file = std::ofstream(options.output_file);
-        file << text << std::flush;
+        timer.stop();
+    } else if (!is_standard_stream(options.output_file)
+        && (options.encode == programMode::encodeParallelNative || options.encode == programMode::encodeParallelFastFlow)) {
+        auto timer = TimingScope("main");
+        auto read_timer = TimingScope("read");
+
+        auto text = read_text_file(options.input_file);
+
+        read_timer.stop();
+        auto encode_timer = TimingScope("encode and write");
+
+        //each worker writes its own segment to the file, after the tag
+        auto output = fileDescriptor{ open_output_file(options.output_file) };
+        auto tag = static_cast<byte>(format_of(options.encode));
+        io::write_at(output.fd, &tag, 1, 0, io::ioBackend::pread);
+
+        if (options.encode == programMode::encodeParallelNative)
+            encoder::encode_parallel_native(std::move(text), options.number_of_workers, output.fd, 1, options.sample_percent);
+        else
+            encoder::encode_parallel_ff(std::move(text), options.number_of_workers, output.fd, 1);
+
+        encode_timer.stop();
+        timer.stop();
     } else {
-#ifdef CHRONO_ENABLED
-        auto& timing = TimingLogger::instance();
-        auto& timer = timing.newTimer("00 - Whole Execution");
-        auto& read_timer = timing.newTimer("01 - Read Input File");
-#endif
+        auto timer = TimingScope("main");
+        auto read_timer = TimingScope("read");
 
         auto text = read_text_file(options.input_file);
 
-#ifdef CHRONO_ENABLED
-        read_timer.stopTimer();
-        auto& encode_timer = timing.newTimer("02 - Encoding Input");
-#endif
+        read_timer.stop();
+        auto encode_timer = TimingScope("encode");
+
+        auto output = outputStream(options.output_file);
+        auto& file = *output;
+        file.put(static_cast<char>(format_of(options.encode)));
 
         std::vector<unsigned char> encoded_text;
         switch (options.encode) {
             default:
             case programMode::encode:
-                encoded_text = encoder::encode(text);
+                encoded_text = encoder::encode(text, options.sample_percent);
+                break;
+            case programMode::encodeInterleaved:
+                encoded_text = encoder::encode_interleaved(text);
+                break;
+            case programMode::encodePretrained:
+                encoded_text = encoder::pretrainedEncoder(read_binary_file(options.table_file)).encode(text);
+                break;
+            case programMode::encodeTans:
+            case programMode::encodeTansParallelNative:
+                encoded_text = tans::encode(text, options.number_of_workers);
+                break;
+            case programMode::encodeTansParallelFastFlow:
+                encoded_text = tans::encode_parallel_ff(text, options.number_of_workers);
                 break;
             case programMode::encodeParallelNative:
-                encoded_text = encoder::encode_parallel_native(text, options.number_of_workers);
+                encoded_text = encoder::encode_parallel_native(text, options.number_of_workers, options.sample_percent);
                 break;
             case programMode::encodeParallelFastFlow:
-                encoded_text = encoder::encode_parallel_ff(text, options.number_of_workers);
+                //the output is written while the segments are being encoded
+                encoder::encode_parallel_ff(text, options.number_of_workers, file);
+                break;
+            case programMode::encodeParallelFastFlowFor:
+                encoded_text = encoder::encode_parallel_ff_for(text, options.number_of_workers, options.grain_size);
                 break;
         }
         
-#ifdef CHRONO_ENABLED
-        encode_timer.stopTimer();
-        auto& write_timer = timing.newTimer("03 - Writing Output");
-#endif
+        encode_timer.stop();
+        auto write_timer = TimingScope("write");
 
-        auto file = std::ofstream(options.output_file);
         file.write(reinterpret_cast<char*>(encoded_text.data()), encoded_text.size());
         file.flush();
 
-#ifdef CHRONO_ENABLED
-        write_timer.stopTimer();
-        timer.stopTimer();
-        timing.logTimers();
-#endif
+        write_timer.stop();
+        timer.stop();
     }
 
     return 0;
+}
+
+int main(int argc, char** argv)
+{
+    auto programOptions = parse_arguments(argc, argv);
+    if (!programOptions.has_value()) {
+        return 1;
+    }
+
+    auto options = programOptions.value();
+    set_direct_io(options.direct_io);
+
+    //the all-chrono build profiles every run
+    auto& timing = TimingLogger::instance();
+    timing.enable(options.profile || timing.is_enabled());
+    auto profile_report = ProfileReport(options.profile_file);
+
+    //corrupt inputs and i/o failures end the program with their message instead of an abort
+    try {
+        return run(options);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,278 @@
+#include "service.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../file_utils.h"
+#include "../format.h"
+#include "../batch/batch.h"
+#include "../decoder/tree_cache.h"
+#include "../timing.h"
+
+namespace huffman::service::detail
+{
+    sockaddr_un socket_address(const std::string& socket_file) {
+        auto address = sockaddr_un();
+        address.sun_family = AF_UNIX;
+        if (socket_file.size() >= sizeof(address.sun_path))
+            throw std::runtime_error("Socket path \"" + socket_file + "\" is too long.");
+
+        std::strcpy(address.sun_path, socket_file.c_str());
+        return address;
+    }
+
+    void write_all(int fd, const void* data, size_t size) {
+        auto bytes = static_cast<const byte*>(data);
+        while (size > 0) {
+            //a client gone away must not kill the server with a SIGPIPE
+            auto written = ::send(fd, bytes, size, MSG_NOSIGNAL);
+            if (written <= 0) throw std::runtime_error(std::string("Socket write failed: ") + std::strerror(errno));
+            bytes += written;
+            size -= written;
+        }
+    }
+
+    void read_all(int fd, void* data, size_t size) {
+        auto bytes = static_cast<byte*>(data);
+        while (size > 0) {
+            auto read = ::read(fd, bytes, size);
+            if (read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+                throw std::runtime_error("Socket read timed out.");
+            if (read <= 0) throw std::runtime_error("Socket closed before the end of the message.");
+            bytes += read;
+            size -= read;
+        }
+    }
+
+    //every field is written as its size (8 bytes) followed by its bytes. larger inputs
+    //than MAX_SERVICE_FIELD_SIZE are to be sent as files.
+    template<class Container>
+    void write_field(int fd, const Container& field) {
+        uint64_t size = field.size();
+        write_all(fd, &size, sizeof(size));
+        write_all(fd, field.data(), size);
+    }
+
+    template<class Container>
+    Container read_field(int fd) {
+        uint64_t size = 0;
+        read_all(fd, &size, sizeof(size));
+        if (size > MAX_SERVICE_FIELD_SIZE)
+            throw std::runtime_error("Message field of " + std::to_string(size) + " bytes is too large.");
+
+        auto field = Container(size, 0);
+        read_all(fd, field.data(), size);
+        return field;
+    }
+
+    void write_request(int fd, const jobRequest& request) {
+        write_all(fd, &request.command, 1);
+        write_field(fd, request.input_file);
+        write_field(fd, request.output_file);
+        write_field(fd, request.payload);
+    }
+
+    jobRequest read_request(int fd) {
+        auto request = jobRequest();
+        read_all(fd, &request.command, 1);
+        request.input_file = read_field<std::string>(fd);
+        request.output_file = read_field<std::string>(fd);
+        request.payload = read_field<std::vector<byte>>(fd);
+        return request;
+    }
+
+    void write_response(int fd, const jobResponse& response) {
+        byte ok = response.ok ? 1 : 0;
+        write_all(fd, &ok, 1);
+        write_all(fd, &response.coding_microseconds, sizeof(uint64_t));
+        write_all(fd, &response.total_microseconds, sizeof(uint64_t));
+        write_field(fd, response.payload);
+    }
+
+    jobResponse read_response(int fd) {
+        auto response = jobResponse();
+        byte ok = 0;
+        read_all(fd, &ok, 1);
+        response.ok = ok == 1;
+        read_all(fd, &response.coding_microseconds, sizeof(uint64_t));
+        read_all(fd, &response.total_microseconds, sizeof(uint64_t));
+        response.payload = read_field<std::vector<byte>>(fd);
+        return response;
+    }
+
+    //only a socket file left by a previous server is replaced, any other file is kept.
+    void remove_stale_socket(const std::string& socket_file) {
+        struct stat status;
+        if (::lstat(socket_file.c_str(), &status) < 0) {
+            if (errno == ENOENT) return;
+            throw std::runtime_error("Could not check \"" + socket_file + "\": " + std::strerror(errno));
+        }
+
+        if (!S_ISSOCK(status.st_mode))
+            throw std::runtime_error("\"" + socket_file + "\" exists and is not a socket.");
+
+        ::unlink(socket_file.c_str());
+    }
+
+    void set_timeouts(int fd, size_t seconds) {
+        auto timeout = timeval{ static_cast<time_t>(seconds), 0 };
+        if (setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) < 0
+            || setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout)) < 0)
+            throw std::runtime_error(std::string("Could not set the socket timeouts: ") + std::strerror(errno));
+    }
+
+    uint64_t microseconds_since(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    //the tag of an encoded input and the bytes following it.
+    std::pair<formatTag, std::vector<byte>> read_encoded_input(const jobRequest& request) {
+        int tag = request.payload.empty() ? EOF : request.payload[0];
+        if (!request.input_file.empty())
+            tag = std::ifstream(request.input_file, std::ios::binary).get();
+
+        if (!is_format_tag(tag))
+            throw std::runtime_error("The input is not an encoded file.");
+
+        if (!request.input_file.empty())
+            return { static_cast<formatTag>(tag), read_binary_file(request.input_file, 1) };
+
+        return { static_cast<formatTag>(tag), std::vector<byte>(request.payload.cbegin() + 1, request.payload.cend()) };
+    }
+
+    void write_output(const jobRequest& request, const char* data, size_t size, jobResponse& response) {
+        if (request.output_file.empty()) {
+            response.payload.assign(data, data + size);
+            return;
+        }
+
+        write_binary_file(request.output_file, data, size);
+    }
+}
+
+namespace huffman::service
+{
+    jobServer::jobServer(const std::string& socket_file, size_t workers, encoder::contextBackend backend, size_t timeout_seconds)
+        : socket_file(socket_file), listen_fd(-1), timeout_seconds(timeout_seconds), encoder(workers, backend, &encoder::tableCache::instance())
+    {
+        auto address = detail::socket_address(socket_file);
+        detail::remove_stale_socket(socket_file);
+
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0)
+            throw std::runtime_error(std::string("Could not create the socket: ") + std::strerror(errno));
+
+        //the jobs read and write files with the rights of the server, so only its owner may connect
+        auto mask = ::umask(0177);
+        auto bound = bind(listen_fd, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        ::umask(mask);
+
+        if (bound < 0 || listen(listen_fd, SOMAXCONN) < 0) {
+            auto error = std::string(std::strerror(errno));
+            ::close(listen_fd);
+            throw std::runtime_error("Could not listen on \"" + socket_file + "\": " + error);
+        }
+    }
+
+    jobServer::~jobServer() {
+        ::close(listen_fd);
+        ::unlink(socket_file.c_str());
+    }
+
+    void jobServer::serve() {
+        while (true) {
+            int fd = accept(listen_fd, nullptr, nullptr);
+            if (fd < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error(std::string("Could not accept a connection: ") + std::strerror(errno));
+            }
+
+            //a client which disconnects halfway, or stays idle, only loses its own job
+            bool stop = false;
+            try {
+                detail::set_timeouts(fd, timeout_seconds);
+                auto request = detail::read_request(fd);
+                stop = request.command == jobCommand::stop;
+                detail::write_response(fd, run(request));
+            } catch (const std::exception&) {}
+
+            ::close(fd);
+            if (stop) return;
+        }
+    }
+
+    jobResponse jobServer::run(const jobRequest& request) {
+        auto start = std::chrono::steady_clock::now();
+        auto response = jobResponse{ true, 0, 0, {} };
+
+        try {
+            if (request.command == jobCommand::encode) {
+                //the daemon profile sums the jobs up
+                auto job_timer = TimingScope("encode job");
+                auto text = request.input_file.empty()
+                    ? std::string(request.payload.cbegin(), request.payload.cend())
+                    : read_text_file(request.input_file);
+
+                auto coding_start = std::chrono::steady_clock::now();
+                auto encoded_text = encoder.encode(text);
+                encoded_text.insert(encoded_text.begin(), static_cast<byte>(formatTag::huffman));
+                response.coding_microseconds = detail::microseconds_since(coding_start);
+
+                detail::write_output(request, reinterpret_cast<char*>(encoded_text.data()), encoded_text.size(), response);
+            } else if (request.command == jobCommand::decode) {
+                auto job_timer = TimingScope("decode job");
+                auto [tag, encoded_text] = detail::read_encoded_input(request);
+
+                auto coding_start = std::chrono::steady_clock::now();
+                auto text = (tag == formatTag::huffman)
+                    ? decoder::decode_cached(encoded_text)
+                    : batch::decode_tagged(tag, encoded_text);
+                response.coding_microseconds = detail::microseconds_since(coding_start);
+
+                detail::write_output(request, text.data(), text.size(), response);
+            } else if (request.command != jobCommand::stop) {
+                throw std::runtime_error("Unknown job command.");
+            }
+        } catch (const std::exception& e) {
+            auto message = std::string(e.what());
+            response.ok = false;
+            response.payload.assign(message.begin(), message.end());
+        }
+
+        response.total_microseconds = detail::microseconds_since(start);
+        return response;
+    }
+
+    jobResponse submit(const std::string& socket_file, const jobRequest& request) {
+        auto address = detail::socket_address(socket_file);
+
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0)
+            throw std::runtime_error(std::string("Could not create the socket: ") + std::strerror(errno));
+
+        if (connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+            auto error = std::string(std::strerror(errno));
+            ::close(fd);
+            throw std::runtime_error("Could not connect to \"" + socket_file + "\": " + error);
+        }
+
+        try {
+            detail::write_request(fd, request);
+            auto response = detail::read_response(fd);
+            ::close(fd);
+            return response;
+        } catch (...) {
+            ::close(fd);
+            throw;
+        }
+    }
+}
\ No newline at end of file
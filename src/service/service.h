@@ -0,0 +1,69 @@
+#ifndef HUFFMAN_SERVICE
+#define HUFFMAN_SERVICE
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../definitions.h"
+#include "../encoder/encoder_context.h"
+
+namespace huffman::service
+{
+    enum class jobCommand : byte {
+        encode = 'E',
+        decode = 'D',
+        stop = 'S'
+    };
+
+    //a job reads its input from input_file, or from the payload when it is empty, and writes
+    //its output to output_file, or back in the payload of the response when it is empty.
+    struct jobRequest {
+        jobCommand command;
+        std::string input_file;
+        std::string output_file;
+        std::vector<byte> payload;
+    };
+
+    //the payload holds the inline output, or the error message of a failed job.
+    struct jobResponse {
+        bool ok;
+        uint64_t coding_microseconds;
+        uint64_t total_microseconds;
+        std::vector<byte> payload;
+    };
+
+    //a jobServer listens on a unix domain socket and runs one job per connection, in order,
+    //keeping its encoder threads and the process-wide table and tree caches warm between jobs.
+    //encoded outputs are tagged as the files written by the command line program.
+    //the socket is only accessible by its owner, and a client idle for timeout_seconds is dropped.
+    class jobServer {
+    private:
+        std::string socket_file;
+        int listen_fd;
+        size_t timeout_seconds;
+        encoder::encoderContext encoder;
+
+    public:
+        jobServer(
+            const std::string& socket_file,
+            size_t workers = 1,
+            encoder::contextBackend backend = encoder::contextBackend::native,
+            size_t timeout_seconds = DEFAULT_SERVICE_TIMEOUT
+        );
+        jobServer(const jobServer&) = delete;
+        jobServer& operator=(const jobServer&) = delete;
+
+        ~jobServer();
+
+        //accepts jobs until a stop job is received.
+        void serve();
+
+        jobResponse run(const jobRequest& request);
+    };
+
+    //sends a job to the server listening on socket_file and waits for its response.
+    jobResponse submit(const std::string& socket_file, const jobRequest& request);
+}
+
+#endif
\ No newline at end of file
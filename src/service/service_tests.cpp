@@ -0,0 +1,136 @@
+#include "service.h"
+
+#include "../test_utils.h"
+
+#include "../file_utils.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace huffman;
+
+std::string service_text() {
+    std::string text;
+    for (size_t i = 0; text.size() < 50000; i++)
+        text += "2024-05-01 INFO request " + std::to_string(i * 7919 % 10007) + " served in " + std::to_string(i % 97) + "ms\n";
+
+    return text;
+}
+
+std::vector<byte> to_bytes(const std::string& text) {
+    return std::vector<byte>(text.begin(), text.end());
+}
+
+void testInlineAndFileJobs(const std::string& socket_file) {
+    auto text = service_text();
+
+    auto encoded = service::submit(socket_file, { service::jobCommand::encode, "", "", to_bytes(text) });
+    assert(encoded.ok, "Expected the inline encoding job to succeed.");
+    assert(encoded.payload.size() < text.size(), "Expected the inline output to be compressed.");
+    assert(encoded.total_microseconds >= encoded.coding_microseconds, "Expected the coding time to be part of the total time.");
+
+    //the same table is decoded twice, the second time from the tree cache
+    for (size_t i = 0; i < 2; i++) {
+        auto decoded = service::submit(socket_file, { service::jobCommand::decode, "", "", encoded.payload });
+        assert(decoded.ok && decoded.payload == to_bytes(text), "Expected the inline decoding job to return the text.");
+    }
+
+    auto directory = std::filesystem::temp_directory_path();
+    auto input = (directory / "huffman_service_tests_input").string();
+    auto output = (directory / "huffman_service_tests_output").string();
+    std::ofstream(input, std::ios::binary) << text;
+
+    auto file_job = service::submit(socket_file, { service::jobCommand::encode, input, output, {} });
+    assert(file_job.ok && file_job.payload.empty(), "Expected the file job to write its output to the file.");
+    assert(read_binary_file(output) == encoded.payload, "Expected the file and the inline outputs to match.");
+
+    std::filesystem::remove(input);
+    std::filesystem::remove(output);
+}
+
+void testFailedJob(const std::string& socket_file) {
+    auto missing = service::submit(socket_file, { service::jobCommand::decode, "/nonexistent/huffman/input", "", {} });
+    assert(!missing.ok && !missing.payload.empty(), "Expected a missing input to fail with a message.");
+
+    auto invalid = service::submit(socket_file, { service::jobCommand::decode, "", "", to_bytes("not encoded") });
+    assert(!invalid.ok, "Expected an input without a format tag to fail.");
+}
+
+int connect_client(const std::string& socket_file) {
+    auto address = sockaddr_un();
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, socket_file.c_str());
+
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    assert(connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0, "Expected the client to connect.");
+    return fd;
+}
+
+//a client which connects and sends nothing is dropped after the timeout.
+void testIdleClient(const std::string& socket_file) {
+    int idle = connect_client(socket_file);
+
+    auto text = service_text();
+    auto encoded = service::submit(socket_file, { service::jobCommand::encode, "", "", to_bytes(text) });
+    assert(encoded.ok, "Expected a job to be served after an idle client.");
+    ::close(idle);
+}
+
+//a field larger than the limit drops the connection before anything is allocated.
+void testOversizedField(const std::string& socket_file) {
+    int client = connect_client(socket_file);
+    auto command = static_cast<byte>(service::jobCommand::encode);
+    uint64_t size = uint64_t(1) << 40;
+    assert(::write(client, &command, 1) == 1 && ::write(client, &size, sizeof(size)) == sizeof(size), "Expected the request to be sent.");
+
+    byte response;
+    assert(::read(client, &response, 1) == 0, "Expected the server to close the connection.");
+    ::close(client);
+
+    auto text = service_text();
+    auto encoded = service::submit(socket_file, { service::jobCommand::encode, "", "", to_bytes(text) });
+    assert(encoded.ok, "Expected a job to be served after an oversized request.");
+}
+
+void testSocketFile(const std::string& socket_file) {
+    auto status = std::filesystem::status(socket_file);
+    assert(status.type() == std::filesystem::file_type::socket, "Expected the server to create a socket file.");
+    assert((status.permissions() & (std::filesystem::perms::group_all | std::filesystem::perms::others_all)) == std::filesystem::perms::none,
+        "Expected the socket to be accessible by its owner only.");
+
+    //a regular file is never replaced by a server
+    auto regular = (std::filesystem::temp_directory_path() / "huffman_service_tests_regular").string();
+    std::ofstream(regular) << "keep";
+
+    bool failed = false;
+    try {
+        auto server = service::jobServer(regular);
+    } catch (const std::runtime_error&) {
+        failed = true;
+    }
+    assert(failed && read_text_file(regular) == "keep", "Expected the server to refuse to replace a regular file.");
+    std::filesystem::remove(regular);
+}
+
+void testMain()
+{
+    auto socket_file = (std::filesystem::temp_directory_path() / "huffman_service_tests.sock").string();
+    auto server = service::jobServer(socket_file, 2, encoder::contextBackend::native, 1);
+    auto thread = std::thread([&]() { server.serve(); });
+
+    testInlineAndFileJobs(socket_file);
+    testFailedJob(socket_file);
+    testIdleClient(socket_file);
+    testOversizedField(socket_file);
+    testSocketFile(socket_file);
+
+    auto stopped = service::submit(socket_file, { service::jobCommand::stop, "", "", {} });
+    thread.join();
+    assert(stopped.ok, "Expected the server to acknowledge the stop job.");
+}
\ No newline at end of file
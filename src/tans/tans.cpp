@@ -0,0 +1,235 @@
+#include "tans.h"
+
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+
+#include "tans_table.h"
+#include "../threads/workerPool.h"
+
+#include <ff/ff.hpp>
+#include <ff/parallel_for.hpp>
+
+#include "../timing.h"
+
+namespace huffman::encoder::detail
+{
+    void extract_frequencies(std::string::const_iterator, std::string::const_iterator, frequencyHistogram&);
+
+    size_t compute_segment_size(std::string const&, size_t);
+
+    std::pair<std::string::const_iterator, std::string::const_iterator> extract_task_range(std::string const&, size_t, size_t, size_t);
+}
+
+namespace huffman::tans::detail
+{
+    using namespace huffman::parallel::native;
+
+    void append_number(size_t number, std::vector<byte>& out_data) {
+        auto number_bytes = reinterpret_cast<byte*>(&number);
+        for (size_t i = 0; i < sizeof(size_t); i++)
+            out_data.push_back(number_bytes[i]);
+    }
+
+    size_t read_number(std::vector<byte>::const_iterator& iter, std::vector<byte>::const_iterator end) {
+        if (std::distance(iter, end) < static_cast<long>(sizeof(size_t)))
+            throw std::runtime_error("The tANS header ends before its segment layout.");
+
+        size_t number = 0;
+        auto number_bytes = reinterpret_cast<byte*>(&number);
+        for (size_t i = 0; i < sizeof(size_t); i++) {
+            number_bytes[i] = *iter; iter++;
+        }
+
+        return number;
+    }
+
+    //the characters are coded last to first, so that the decoder reads them in order.
+    void encode_segment(
+        const tansTable& table,
+        std::string::const_iterator text_start,
+        std::string::const_iterator text_end,
+        std::vector<byte>& out_data
+    ) {
+        auto writer = forwardBitWriter(out_data);
+        size_t state = STATES;
+
+        for (auto iter = text_end; iter != text_start;) {
+            --iter;
+            table.encode(state, static_cast<byte>(*iter), writer);
+        }
+
+        writer.write(state - STATES, TABLE_LOG);
+        writer.close();
+    }
+
+    void decode_segment(
+        const tansTable& table,
+        const byte* data,
+        size_t size,
+        size_t number_of_characters,
+        char* out_text
+    ) {
+        auto reader = backwardBitReader(data, size);
+        size_t state = reader.read(TABLE_LOG);
+
+        for (size_t i = 0; i < number_of_characters; i++)
+            out_text[i] = table.decode(state, reader);
+    }
+
+    //for_each(task) runs task(segment) for every segment.
+    template<class ForEach>
+    std::vector<byte> encode_segments(const std::string& text, size_t segments, ForEach&& for_each) {
+        auto frequencies_timer = TimingScope("frequencies");
+
+        //extract frequencies of letters (map)
+        auto segment_size = encoder::detail::compute_segment_size(text, segments);
+        auto frequencies = std::vector<encoder::frequencyHistogram>(segments);
+        for_each([&](size_t segment) {
+            auto [begin, end] = encoder::detail::extract_task_range(text, segment_size, segments, segment);
+            encoder::detail::extract_frequencies(begin, end, frequencies[segment]);
+        });
+
+        //compute total frequencies (reduce)
+        auto total_frequencies = encoder::frequencyHistogram();
+        total_frequencies.fill(0);
+        for (auto const& partial : frequencies) {
+            for (size_t i = 0; i < TABLE_SIZE; i++)
+                total_frequencies[i] += partial[i];
+        }
+
+        frequencies_timer.stop();
+        auto encodingTable_timer = TimingScope("table");
+
+        //build the coding table
+        auto table = std::make_unique<tansTable>(total_frequencies);
+
+        encodingTable_timer.stop();
+        auto serialization_timer = TimingScope("serialization");
+
+        //encode each segment in its own stream (map)
+        auto encoded_segments = std::vector<std::vector<byte>>(segments);
+        for_each([&](size_t segment) {
+            auto [begin, end] = encoder::detail::extract_task_range(text, segment_size, segments, segment);
+            encode_segment(*table, begin, end, encoded_segments[segment]);
+        });
+
+        //table, number of characters, number of segments, then the characters and bytes
+        //of each segment, followed by the segments themselves (reduce)
+        auto out_data = std::vector<byte>();
+        table->serialize(out_data);
+        append_number(text.size(), out_data);
+        append_number(segments, out_data);
+        for (size_t i = 0; i < segments; i++) {
+            auto [begin, end] = encoder::detail::extract_task_range(text, segment_size, segments, i);
+            append_number(end - begin, out_data);
+            append_number(encoded_segments[i].size(), out_data);
+        }
+
+        for (auto const& segment : encoded_segments)
+            out_data.insert(out_data.end(), segment.begin(), segment.end());
+
+        serialization_timer.stop();
+
+        return out_data;
+    }
+
+    template<class F>
+    void run_on_pool(workerPool* pool, size_t segments, F task) {
+        if (!pool) {
+            for (size_t i = 0; i < segments; i++)
+                task(i);
+            return;
+        }
+
+        auto workers = pool->size();
+        auto strided = [&](size_t worker) {
+            for (size_t i = worker; i < segments; i += workers)
+                task(i);
+        };
+        pool->run(strided);
+    }
+}
+
+namespace huffman::tans
+{
+    using namespace huffman::parallel::native;
+
+    std::vector<byte> encode(const std::string& text, size_t workers) {
+        if (workers == 0) workers = 1;
+        auto pool = (workers > 1) ? std::make_unique<workerPool>(workers) : nullptr;
+
+        return detail::encode_segments(text, workers, [&](auto task) {
+            detail::run_on_pool(pool.get(), workers, task);
+        });
+    }
+
+    std::vector<byte> encode_parallel_ff(const std::string& text, size_t workers) {
+        if (workers == 0) workers = 1;
+        auto pf = ff::ParallelFor(workers);
+
+        return detail::encode_segments(text, workers, [&](auto task) {
+            pf.parallel_for(0, workers, 1, 1, [&task](const long segment) {
+                task(segment);
+            }, workers);
+        });
+    }
+
+    std::string decode(const std::vector<byte>& encoded_text, size_t workers) {
+        auto iter = encoded_text.cbegin();
+        auto end = encoded_text.cend();
+
+        //decode the table
+        auto table = std::make_unique<tansTable>(iter, end);
+
+        //get the number of characters and the layout of the segments, two numbers each
+        auto number_of_characters = detail::read_number(iter, end);
+        auto segments = detail::read_number(iter, end);
+        if (segments > static_cast<size_t>(end - iter) / (2 * sizeof(size_t)))
+            throw std::runtime_error("Invalid tANS segment layout.");
+
+        auto segment_characters = std::vector<size_t>(segments);
+        auto segment_bytes = std::vector<size_t>(segments);
+        size_t total_characters = 0;
+        size_t total_bytes = 0;
+        for (size_t i = 0; i < segments; i++) {
+            segment_characters[i] = detail::read_number(iter, end);
+            segment_bytes[i] = detail::read_number(iter, end);
+
+            //checked one at a time, so that the sums cannot wrap around
+            if (segment_characters[i] > number_of_characters - total_characters
+                || segment_bytes[i] > static_cast<size_t>(end - iter) - total_bytes)
+                throw std::runtime_error("Invalid tANS segment layout.");
+
+            total_characters += segment_characters[i];
+            total_bytes += segment_bytes[i];
+        }
+
+        auto data_start = static_cast<size_t>(iter - encoded_text.cbegin());
+        if (total_characters != number_of_characters || data_start + total_bytes > encoded_text.size())
+            throw std::runtime_error("Invalid tANS segment layout.");
+
+        //decode each segment in its own slice of the output (map)
+        auto text = std::string(number_of_characters, 0);
+        auto text_offsets = std::vector<size_t>(segments);
+        auto data_offsets = std::vector<size_t>(segments);
+        for (size_t i = 1; i < segments; i++) {
+            text_offsets[i] = text_offsets[i - 1] + segment_characters[i - 1];
+            data_offsets[i] = data_offsets[i - 1] + segment_bytes[i - 1];
+        }
+
+        workers = std::min(std::max<size_t>(workers, 1), std::max<size_t>(segments, 1));
+        auto pool = (workers > 1) ? std::make_unique<workerPool>(workers) : nullptr;
+        detail::run_on_pool(pool.get(), segments, [&](size_t segment) {
+            detail::decode_segment(
+                *table,
+                encoded_text.data() + data_start + data_offsets[segment],
+                segment_bytes[segment],
+                segment_characters[segment],
+                text.data() + text_offsets[segment]
+            );
+        });
+
+        return text;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,21 @@
+#ifndef HUFFMAN_TANS
+#define HUFFMAN_TANS
+
+#include <string>
+#include <vector>
+
+#include "../definitions.h"
+
+namespace huffman::tans
+{
+    //the text is split in one segment per worker, like encode_parallel_native does, and every
+    //segment is coded as an independent stream, so that both encoding and decoding run in parallel.
+    std::vector<byte> encode(const std::string& text, size_t workers = 1);
+
+    //same format, with the segments scheduled on a FastFlow ParallelFor.
+    std::vector<byte> encode_parallel_ff(const std::string& text, size_t workers);
+
+    std::string decode(const std::vector<byte>& encoded_text, size_t workers = 1);
+}
+
+#endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef HUFFMAN_TANS_BITS
+#define HUFFMAN_TANS_BITS
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "../definitions.h"
+
+namespace huffman::tans
+{
+    //packs values least significant bit first; the stream ends with a 1 bit,
+    //so that the reader can find its last valid bit.
+    struct forwardBitWriter {
+    private:
+        std::vector<byte>& data;
+        uint64_t container;
+        size_t bits;
+
+    public:
+        forwardBitWriter(std::vector<byte>& data)
+            : data(data), container(0), bits(0) {}
+
+        inline void write(size_t value, size_t count) {
+            container |= static_cast<uint64_t>(value) << bits;
+            bits += count;
+            while (bits >= 8) {
+                data.push_back(static_cast<byte>(container));
+                container >>= 8;
+                bits -= 8;
+            }
+        }
+
+        inline void close() {
+            write(1, 1);
+            if (bits > 0) data.push_back(static_cast<byte>(container));
+        }
+    };
+
+    //reads the values of a forwardBitWriter in the opposite order they were written.
+    struct backwardBitReader {
+    private:
+        const byte* data;
+        size_t size;
+        size_t position;
+
+    public:
+        backwardBitReader(const byte* data, size_t size)
+            : data(data), size(size)
+        {
+            if (size == 0 || data[size - 1] == 0)
+                throw std::runtime_error("tANS stream is missing its end marker.");
+
+            auto last = data[size - 1];
+            size_t highest_bit = 7;
+            while (!(last >> highest_bit)) highest_bit--;
+            position = (size - 1) * 8 + highest_bit;
+        }
+
+        inline size_t read(size_t count) {
+            if (count > position)
+                throw std::runtime_error("tANS stream is shorter than expected.");
+
+            position -= count;
+            auto index = position / 8;
+            uint32_t window = 0;
+            for (size_t i = 0; i < 3 && index + i < size; i++)
+                window |= static_cast<uint32_t>(data[index + i]) << (8 * i);
+
+            return (window >> (position % 8)) & ((1u << count) - 1);
+        }
+    };
+}
+
+#endif
\ No newline at end of file
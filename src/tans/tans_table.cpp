@@ -0,0 +1,153 @@
+#include "tans_table.h"
+
+#include <iterator>
+#include <stdexcept>
+
+namespace huffman::tans
+{
+    inline size_t highest_bit(size_t value) {
+        size_t bit = 0;
+        while (value >>= 1) bit++;
+        return bit;
+    }
+
+    normalizedHistogram normalize_frequencies(const encoder::frequencyHistogram& frequencies) {
+        auto normalized = normalizedHistogram();
+        normalized.fill(0);
+
+        size_t total = 0;
+        size_t largest = 0;
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            total += frequencies[i];
+            if (frequencies[i] > frequencies[largest]) largest = i;
+        }
+        if (total == 0) return normalized;
+
+        //scale down, rounding towards zero but never below one state
+        long long remaining = STATES;
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            if (frequencies[i] == 0) continue;
+
+            //the product overflows only for counts above 2^53, which are scaled in floating point
+            auto scaled = (frequencies[i] <= SIZE_MAX / STATES)
+                ? static_cast<size_t>(frequencies[i]) * STATES / total
+                : static_cast<size_t>(static_cast<long double>(frequencies[i]) * STATES / total);
+            normalized[i] = (scaled == 0) ? 1 : scaled;
+            remaining -= normalized[i];
+        }
+
+        //the states left over go to the most frequent character, the ones in excess
+        //(because of the characters rounded up to one) are taken from the largest counts
+        if (remaining > 0)
+            normalized[largest] += remaining;
+
+        while (remaining < 0) {
+            size_t biggest = 0;
+            for (size_t i = 1; i < TABLE_SIZE; i++)
+                if (normalized[i] > normalized[biggest]) biggest = i;
+
+            normalized[biggest]--;
+            remaining++;
+        }
+
+        return normalized;
+    }
+
+    tansTable::tansTable() {
+        counts.fill(0);
+        build();
+    }
+
+    tansTable::tansTable(const encoder::frequencyHistogram& frequencies)
+        : counts(normalize_frequencies(frequencies))
+    {
+        build();
+    }
+
+    tansTable::tansTable(std::vector<byte>::const_iterator& serialized, std::vector<byte>::const_iterator end) {
+        counts.fill(0);
+
+        if (std::distance(serialized, end) < 2)
+            throw std::runtime_error("Invalid tANS table, it ends before its number of characters.");
+
+        size_t characters = *serialized; serialized++;
+        characters |= static_cast<size_t>(*serialized) << 8; serialized++;
+        if (characters > TABLE_SIZE)
+            throw std::runtime_error("Invalid tANS table, too many characters.");
+        if (std::distance(serialized, end) < static_cast<long>(3 * characters))
+            throw std::runtime_error("Invalid tANS table, it ends before its characters.");
+
+        size_t total = 0;
+        for (size_t i = 0; i < characters; i++) {
+            auto character = *serialized; serialized++;
+            uint16_t count = *serialized; serialized++;
+            count |= static_cast<uint16_t>(*serialized) << 8; serialized++;
+
+            counts[character] = count;
+            total += count;
+        }
+
+        if (total != 0 && total != STATES)
+            throw std::runtime_error("Invalid tANS table, the counts do not sum to the number of states.");
+
+        build();
+    }
+
+    void tansTable::serialize(std::vector<byte>& out_data) const {
+        //number of characters as two bytes, then for each one the character and its count
+        size_t characters = 0;
+        for (auto count : counts)
+            if (count > 0) characters++;
+
+        out_data.push_back(static_cast<byte>(characters));
+        out_data.push_back(static_cast<byte>(characters >> 8));
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            if (counts[i] == 0) continue;
+
+            out_data.push_back(static_cast<byte>(i));
+            out_data.push_back(static_cast<byte>(counts[i]));
+            out_data.push_back(static_cast<byte>(counts[i] >> 8));
+        }
+    }
+
+    void tansTable::build() {
+        //spread the characters over the states, with a step coprime with the table size
+        constexpr size_t step = (STATES >> 1) + (STATES >> 3) + 3;
+        auto spread = std::array<byte, STATES>();
+        size_t position = 0;
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            for (size_t j = 0; j < counts[i]; j++) {
+                spread[position] = static_cast<byte>(i);
+                position = (position + step) & (STATES - 1);
+            }
+        }
+
+        size_t start = 0;
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            auto& symbol = symbols[i];
+            symbol.count = counts[i];
+            symbol.start = start;
+            start += counts[i];
+
+            //a state x is reduced to [count, 2 * count) by dropping max_bits bits, or one less
+            symbol.max_bits = (counts[i] == 0) ? 0 : TABLE_LOG - highest_bit(counts[i]);
+            symbol.threshold = static_cast<uint32_t>(counts[i]) << symbol.max_bits;
+        }
+
+        //the j-th state of a character, in table order, is reached from the reduced state count + j
+        auto occurrences = std::array<uint16_t, TABLE_SIZE>();
+        occurrences.fill(0);
+        for (size_t state = 0; state < STATES && start == STATES; state++) {
+            auto character = spread[state];
+            auto& symbol = symbols[character];
+            auto reduced = symbol.count + occurrences[character]++;
+
+            next_state[symbol.start + reduced - symbol.count] = STATES + state;
+
+            auto& entry = decode_table[state];
+            entry.character = character;
+            entry.bits = TABLE_LOG - highest_bit(reduced);
+            entry.new_state_base = (reduced << entry.bits) - STATES;
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#ifndef HUFFMAN_TANS_TABLE
+#define HUFFMAN_TANS_TABLE
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "tans_bits.h"
+#include "../definitions.h"
+#include "../encoder/encoder_table.h"
+
+namespace huffman::tans
+{
+    //the frequencies are scaled so that they sum to the number of states.
+    constexpr size_t TABLE_LOG = 11;
+    constexpr size_t STATES = 1 << TABLE_LOG;
+
+    using normalizedHistogram = std::array<uint16_t, TABLE_SIZE>;
+
+    //normalizes the frequencies, keeping at least one state for every character which appears.
+    normalizedHistogram normalize_frequencies(const encoder::frequencyHistogram& frequencies);
+
+    //table based asymmetric numeral system: each character owns as many states as its normalized
+    //frequency, spread over the table, so that it is coded with a fractional number of bits.
+    //the encoder state lives in [STATES, 2 * STATES), the decoder state in [0, STATES).
+    class tansTable {
+    private:
+        struct encodeSymbol {
+            uint32_t threshold;
+            uint16_t start;
+            uint16_t count;
+            byte max_bits;
+        };
+
+        struct decodeEntry {
+            uint16_t new_state_base;
+            byte character;
+            byte bits;
+        };
+
+        normalizedHistogram counts;
+        std::array<encodeSymbol, TABLE_SIZE> symbols;
+        std::array<uint16_t, STATES> next_state;
+        std::array<decodeEntry, STATES> decode_table;
+
+        void build();
+
+    public:
+        tansTable();
+        tansTable(const encoder::frequencyHistogram& frequencies);
+        //reads a table written by serialize, which ends at the given iterator.
+        tansTable(std::vector<byte>::const_iterator& serialized, std::vector<byte>::const_iterator end);
+
+        inline const normalizedHistogram& get_counts() const {
+            return counts;
+        }
+
+        void serialize(std::vector<byte>& out_data) const;
+
+        inline void encode(size_t& state, byte character, forwardBitWriter& writer) const {
+            auto& symbol = symbols[character];
+            size_t bits = symbol.max_bits - (state < symbol.threshold);
+            writer.write(state & ((size_t(1) << bits) - 1), bits);
+            state = next_state[symbol.start + (state >> bits) - symbol.count];
+        }
+
+        inline char decode(size_t& state, backwardBitReader& reader) const {
+            auto& entry = decode_table[state];
+            state = entry.new_state_base + reader.read(entry.bits);
+            return static_cast<char>(entry.character);
+        }
+    };
+}
+
+#endif
\ No newline at end of file
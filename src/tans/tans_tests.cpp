@@ -0,0 +1,127 @@
+#include "tans.h"
+
+#include "../test_utils.h"
+
+#include "tans_table.h"
+
+using namespace huffman;
+
+void assertRoundTrip(const std::string& text, size_t workers) {
+    auto encoded = tans::encode(text, workers);
+    auto decoded = tans::decode(encoded, workers);
+    assert(decoded == text, "Round trip failed for a text of ", text.size(), " characters with ", workers, " workers.");
+}
+
+void testNormalizedCountsSumToStates() {
+    //the second count is large enough to overflow when multiplied by the number of states
+    for (uint64_t largest : {static_cast<uint64_t>(1000000), static_cast<uint64_t>(1) << 60}) {
+        auto frequencies = encoder::frequencyHistogram();
+        for (size_t i = 0; i < TABLE_SIZE; i++)
+            frequencies[i] = (i == 0) ? largest : 1;
+
+        auto normalized = tans::normalize_frequencies(frequencies);
+        size_t total = 0;
+        for (size_t i = 0; i < TABLE_SIZE; i++) {
+            assert(normalized[i] > 0, "Character ", i, " has no state.");
+            total += normalized[i];
+        }
+        assert(total == tans::STATES, "Expected ", tans::STATES, " states but found ", total);
+    }
+}
+
+void testRoundTrip() {
+    std::string text;
+    for (size_t i = 0; i < 100000; i++)
+        text.push_back(static_cast<char>((i * i + i / 3) % 29));
+
+    std::string all_characters;
+    for (size_t i = 0; i < 4 * TABLE_SIZE; i++)
+        all_characters.push_back(static_cast<char>(i));
+
+    for (size_t workers : {1, 3, 8}) {
+        assertRoundTrip("", workers);
+        assertRoundTrip("a", workers);
+        assertRoundTrip(std::string(5000, 'a'), workers);
+        assertRoundTrip("this is an example of a huffman tree", workers);
+        assertRoundTrip(all_characters, workers);
+        assertRoundTrip(text, workers);
+    }
+}
+
+void testFastFlowMatchesNative() {
+    std::string text;
+    for (size_t i = 0; i < 50000; i++)
+        text.push_back(static_cast<char>(i % 17));
+
+    auto native = tans::encode(text, 4);
+    auto fastflow = tans::encode_parallel_ff(text, 4);
+    assert(native == fastflow, "The FastFlow and native encodings differ.");
+}
+
+void testSkewedTextBeatsOneBitPerCharacter() {
+    //huffman can not go below one bit per character, tANS can
+    std::string text;
+    for (size_t i = 0; i < 80000; i++)
+        text.push_back((i % 20 == 0) ? 'b' : 'a');
+
+    auto encoded = tans::encode(text);
+    assert(encoded.size() < text.size() / 8, "Expected less than ", text.size() / 8, " bytes but found ", encoded.size());
+}
+
+bool decode_fails(const std::vector<byte>& encoded) {
+    try {
+        tans::decode(encoded, 3);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+size_t get_number(const std::vector<byte>& encoded, size_t offset) {
+    size_t number = 0;
+    for (size_t i = 0; i < sizeof(size_t); i++)
+        number |= static_cast<size_t>(encoded[offset + i]) << (8 * i);
+    return number;
+}
+
+void set_number(std::vector<byte>& encoded, size_t offset, size_t number) {
+    for (size_t i = 0; i < sizeof(size_t); i++)
+        encoded[offset + i] = static_cast<byte>(number >> (8 * i));
+}
+
+void testCorruptHeaders() {
+    auto encoded = tans::encode("this is an example of a huffman tree", 3);
+
+    //every prefix misses a part of the table, of the segment layout or of the data
+    for (size_t size = 0; size < encoded.size(); size++) {
+        auto truncated = std::vector<byte>(encoded.begin(), encoded.begin() + size);
+        assert(decode_fails(truncated), "Expected a file truncated to ", size, " bytes to be rejected.");
+    }
+
+    //the number of segments follows the table and the number of characters
+    auto characters = encoded[0] | (encoded[1] << 8);
+    auto segments_offset = 2 + 3 * characters + sizeof(size_t);
+    assert(get_number(encoded, segments_offset) == 3, "Expected a segment per worker.");
+    for (size_t segments : {size_t(1) << 40, ~size_t(0)}) {
+        auto corrupt = encoded;
+        set_number(corrupt, segments_offset, segments);
+        assert(decode_fails(corrupt), "Expected a layout of ", segments, " segments to be rejected.");
+    }
+
+    //the sizes of the first two segments still add up to the totals, once they wrap around
+    auto first_characters = segments_offset + sizeof(size_t);
+    auto second_characters = first_characters + 2 * sizeof(size_t);
+    auto wrapped = encoded;
+    set_number(wrapped, first_characters, get_number(encoded, first_characters) + (size_t(1) << 63));
+    set_number(wrapped, second_characters, get_number(encoded, second_characters) + (size_t(1) << 63));
+    assert(decode_fails(wrapped), "Expected a layout whose sizes wrap around to be rejected.");
+}
+
+void testMain()
+{
+    testNormalizedCountsSumToStates();
+    testRoundTrip();
+    testFastFlowMatchesNative();
+    testSkewedTextBeatsOneBitPerCharacter();
+    testCorruptHeaders();
+}
\ No newline at end of file
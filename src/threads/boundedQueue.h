@@ -0,0 +1,58 @@
+#ifndef BOUNDED_QUEUE
+#define BOUNDED_QUEUE
+
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+namespace huffman::parallel::native
+{
+    //a blocking first in first out queue of at most capacity elements, linking two pipeline stages:
+    //the producer closes it after its last push, and pop fails once it is closed and empty.
+    //a consumer which stops early closes it too, so that push fails instead of blocking.
+    template<class T>
+    class boundedQueue {
+    private:
+        std::mutex mutex;
+        std::condition_variable not_empty;
+        std::condition_variable not_full;
+        std::deque<T> items;
+        size_t capacity;
+        bool closed;
+
+    public:
+        boundedQueue(size_t capacity) : capacity(capacity), closed(false) {}
+        boundedQueue(const boundedQueue&) = delete;
+        boundedQueue& operator=(const boundedQueue&) = delete;
+
+        bool push(T item) {
+            auto lock = std::unique_lock(mutex);
+            not_full.wait(lock, [this]() { return closed || items.size() < capacity; });
+            if (closed) return false;
+
+            items.push_back(std::move(item));
+            not_empty.notify_one();
+            return true;
+        }
+
+        bool pop(T& item) {
+            auto lock = std::unique_lock(mutex);
+            not_empty.wait(lock, [this]() { return closed || !items.empty(); });
+            if (items.empty()) return false;
+
+            item = std::move(items.front());
+            items.pop_front();
+            not_full.notify_one();
+            return true;
+        }
+
+        void close() {
+            auto lock = std::unique_lock(mutex);
+            closed = true;
+            not_empty.notify_all();
+            not_full.notify_all();
+        }
+    };
+}
+
+#endif
\ No newline at end of file
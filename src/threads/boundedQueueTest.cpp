@@ -0,0 +1,55 @@
+#include "boundedQueue.h"
+
+#include <thread>
+#include "../test_utils.h"
+
+using namespace huffman::parallel::native;
+
+void testOrderIsPreserved() {
+    auto queue = boundedQueue<int>(2);
+
+    auto producer = std::thread([&]() {
+        for (int i = 0; i < 1000; i++)
+            queue.push(i);
+        queue.close();
+    });
+
+    int expected = 0;
+    for (int value; queue.pop(value); expected++)
+        assert(value == expected, "Expected ", expected, " to be popped, but found: ", value);
+
+    producer.join();
+    assert(expected == 1000, "Expected 1000 values, but found: ", expected);
+}
+
+void testPopAfterClose() {
+    auto queue = boundedQueue<int>(4);
+    queue.push(7);
+    queue.close();
+
+    int value = 0;
+    assert(queue.pop(value) && value == 7, "Expected the values pushed before closing to be popped.");
+    assert(!queue.pop(value), "Expected pop to fail on a closed and empty queue.");
+}
+
+void testPushAfterClose() {
+    auto queue = boundedQueue<int>(1);
+    queue.push(1);
+
+    //the consumer gives up while the producer waits for room
+    auto producer = std::thread([&]() {
+        assert(!queue.push(2), "Expected push to fail on a closed queue.");
+    });
+    queue.close();
+    producer.join();
+
+    int value = 0;
+    assert(queue.pop(value) && value == 1 && !queue.pop(value), "Expected only the value pushed before closing.");
+}
+
+void testMain()
+{
+    testOrderIsPreserved();
+    testPopAfterClose();
+    testPushAfterClose();
+}
\ No newline at end of file
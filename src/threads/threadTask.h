@@ -14,6 +14,7 @@ namespace huffman::parallel::native
     threadTask spawnThread();
     template<class R, class ...ArgTypes> inline threadResult<R, ArgTypes...> submitTask(threadTask&&, std::function<R(ArgTypes...)>, ArgTypes...);
     template<class R, class ...ArgTypes> inline threadTask getResult(threadResult<R, ArgTypes...>&&, R&);
+    template<class ...ArgTypes> inline threadTask getResult(threadResult<void, ArgTypes...>&&);
     
     //a threadTask object owns a thread which is waiting for a new task.
     class threadTask {
@@ -24,6 +25,7 @@ namespace huffman::parallel::native
         template<class R, class ...ArgTypes> friend class threadResult;
         friend threadTask spawnThread();
         template<class R, class ...ArgTypes> friend threadTask getResult(threadResult<R, ArgTypes...>&&, R&);
+        template<class ...ArgTypes> friend threadTask getResult(threadResult<void, ArgTypes...>&&);
 
     public:
         threadTask() = default;
@@ -41,6 +43,16 @@ namespace huffman::parallel::native
             if( task->valid() )
                 output = task->get_future().get();
         }
+
+        //a task without a result is only waited for, rethrowing its exception.
+        template<class ...ArgTypes>
+        threadTask(threadResult<void, ArgTypes...>&& thread)
+            : thread(std::move(thread.thread)), task_promise(std::move(thread.task_promise))
+        {
+            auto task = std::move(thread.task);
+            if( task->valid() )
+                task->get_future().get();
+        }
     };
 
     //a threadResult object owns a thread which is executing a task.
@@ -90,6 +102,11 @@ namespace huffman::parallel::native
         return threadTask(std::move(thread), output);
     }
 
+    template<class ...ArgTypes>
+    threadTask getResult(threadResult<void, ArgTypes...>&& thread) {
+        return threadTask(std::move(thread));
+    }
+
     inline void closeThread(threadTask&& thread) { }
 
     template<class R, class ...ArgTypes>
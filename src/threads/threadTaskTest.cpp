@@ -41,6 +41,17 @@ void testTwoTasks() {
     assert(result1 == 10.5f, "Expected result to be 10.5f, but found: ", result1);
 }
 
+void testVoidTask() {
+    auto thread_initialization = spawnThread();
+
+    int result = 0;
+    std::function<void(int*)> task = [](int* output) { *output = 5; };
+    auto first_task_submit = submitTask(std::move(thread_initialization), task, &result);
+    auto first_task_result = getResult(std::move(first_task_submit));
+
+    assert(result == 5, "Expected result to be 5, but found: ", result);
+}
+
 void testTaskNotRetrieved() {
     auto thread_initialization = spawnThread();
 
@@ -89,6 +100,7 @@ void testMain()
     testSpawnAndTerminateThread();
     testOneTask();
     testTwoTasks();
+    testVoidTask();
     testTaskNotRetrieved();
     testManualTermination();
     testManualTermination2();
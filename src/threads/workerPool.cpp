@@ -0,0 +1,77 @@
+#include "workerPool.h"
+
+#include <utility>
+
+namespace huffman::parallel::native
+{
+    workerPool::workerPool(size_t workers)
+        : task(nullptr), invoke(nullptr), generation(0), pending(0), stop(false)
+    {
+        threads.reserve(workers);
+        for(size_t i = 0; i < workers; i++) {
+            threads.emplace_back(&workerPool::workerFunction, this, i);
+        }
+    }
+
+    workerPool::~workerPool() {
+        {
+            auto lock = std::unique_lock(mutex);
+            stop = true;
+        }
+
+        start_condition.notify_all();
+        for(auto& thread : threads) {
+            if (thread.joinable())
+                thread.join();
+        }
+    }
+
+    void workerPool::run(void* task, void (*invoke)(void*, size_t)) {
+        auto lock = std::unique_lock(mutex);
+        this->task = task;
+        this->invoke = invoke;
+        pending = threads.size();
+        generation++;
+
+        start_condition.notify_all();
+        done_condition.wait(lock, [this]() { return pending == 0; });
+
+        //the first exception of the job, the others are dropped
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+    }
+
+    void workerPool::workerFunction(size_t worker) {
+        size_t last_generation = 0;
+        while (true) {
+            void* current_task;
+            void (*current_invoke)(void*, size_t);
+            {
+                auto lock = std::unique_lock(mutex);
+                start_condition.wait(lock, [&]() { return stop || generation != last_generation; });
+
+                if (stop) return;
+
+                last_generation = generation;
+                current_task = task;
+                current_invoke = invoke;
+            }
+
+            auto current_error = std::exception_ptr();
+            try {
+                current_invoke(current_task, worker);
+            } catch (...) {
+                current_error = std::current_exception();
+            }
+
+            {
+                auto lock = std::unique_lock(mutex);
+                if (current_error && !error)
+                    error = current_error;
+                pending--;
+                if (pending == 0)
+                    done_condition.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,53 @@
+#ifndef WORKER_POOL
+#define WORKER_POOL
+
+#include <exception>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+
+namespace huffman::parallel::native
+{
+    //a workerPool object owns a fixed set of threads which are kept alive between jobs.
+    //each job runs the same function on every worker, passing the worker index, and
+    //dispatching a job does not allocate memory. an exception thrown by a worker is rethrown
+    //by run, once every worker has completed the job.
+    class workerPool {
+    private:
+        std::vector<std::thread> threads;
+        std::mutex mutex;
+        std::condition_variable start_condition;
+        std::condition_variable done_condition;
+
+        void* task;
+        void (*invoke)(void*, size_t);
+        size_t generation;
+        size_t pending;
+        bool stop;
+        std::exception_ptr error;
+
+    public:
+        workerPool(size_t workers);
+        workerPool(const workerPool&) = delete;
+        workerPool& operator=(const workerPool&) = delete;
+
+        ~workerPool();
+
+        inline size_t size() const {
+            return threads.size();
+        }
+
+        //runs task(worker) on every worker and waits for all of them to complete.
+        template<class F>
+        void run(F& task) {
+            run(&task, [](void* function, size_t worker) { (*static_cast<F*>(function))(worker); });
+        }
+
+    private:
+        void run(void* task, void (*invoke)(void*, size_t));
+        void workerFunction(size_t worker);
+    };
+}
+
+#endif
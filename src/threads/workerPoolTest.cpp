@@ -0,0 +1,78 @@
+#include "workerPool.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include "../test_utils.h"
+
+using namespace huffman::parallel::native;
+
+void testSpawnAndTerminatePool() {
+    auto pool = workerPool(4);
+}
+
+void testEveryWorkerRuns() {
+    auto pool = workerPool(4);
+
+    std::vector<int> results(pool.size(), 0);
+    auto task = [&](size_t worker) { results[worker] = worker + 1; };
+    pool.run(task);
+
+    for(size_t i = 0; i < results.size(); i++)
+        assert(results[i] == static_cast<int>(i + 1), "Expected worker ", i, " to write ", i + 1, ", but found: ", results[i]);
+}
+
+void testManyJobs() {
+    auto pool = workerPool(3);
+
+    std::atomic<int> counter = 0;
+    auto task = [&](size_t) { counter++; };
+    for(size_t i = 0; i < 100; i++)
+        pool.run(task);
+
+    assert(counter == 300, "Expected 300 executions, but found: ", counter.load());
+}
+
+void testExecutedNotInMainThread() {
+    auto pool = workerPool(2);
+
+    std::vector<std::thread::id> ids(pool.size());
+    auto task = [&](size_t worker) { ids[worker] = std::this_thread::get_id(); };
+    pool.run(task);
+
+    for(auto id : ids)
+        assert(id != std::this_thread::get_id(), "Code has not been run in a non-main thread.");
+}
+
+void testExceptionIsRethrown() {
+    auto pool = workerPool(3);
+
+    std::atomic<int> counter = 0;
+    auto task = [&](size_t worker) {
+        counter++;
+        if (worker == 1) throw std::runtime_error("worker failure");
+    };
+
+    bool failed = false;
+    try {
+        pool.run(task);
+    } catch (const std::runtime_error& e) {
+        failed = std::string(e.what()) == "worker failure";
+    }
+    assert(failed, "Expected the exception of the worker to be rethrown by run.");
+    assert(counter == 3, "Expected every worker to complete the job, but found: ", counter.load());
+
+    //the pool is still usable
+    auto next = [&](size_t) { counter++; };
+    pool.run(next);
+    assert(counter == 6, "Expected the next job to run on every worker, but found: ", counter.load());
+}
+
+void testMain()
+{
+    testSpawnAndTerminatePool();
+    testEveryWorkerRuns();
+    testManyJobs();
+    testExecutedNotInMainThread();
+    testExceptionIsRethrown();
+}
\ No newline at end of file
@@ -1,29 +1,60 @@
 #include "timing.h"
 
+#include <algorithm>
+#include <fstream>
 #include <iostream>
 #include <iomanip>
 
-Timer::Timer() {
-    start_time = std::chrono::steady_clock::now();
-}
+void ThreadTimings::record(const std::string& path, uint64_t elapsed_ns) {
+    auto lock = std::lock_guard(mutex);
+
+    auto [iter, inserted] = indexes.emplace(path, stats.size());
+    if (inserted) {
+        stats.push_back({ path, thread, 1, elapsed_ns, elapsed_ns, elapsed_ns });
+        return;
+    }
 
-Timer::~Timer() {
-    stopTimer();
+    auto& entry = stats[iter->second];
+    entry.count++;
+    entry.total_ns += elapsed_ns;
+    entry.min_ns = std::min(entry.min_ns, elapsed_ns);
+    entry.max_ns = std::max(entry.max_ns, elapsed_ns);
 }
 
-void Timer::stopTimer() {
-    if (end_time == std::chrono::time_point<std::chrono::steady_clock>()) {
-        end_time = std::chrono::steady_clock::now();
+double ParallelRun::imbalance() const {
+    uint64_t total = 0, busiest = 0;
+    for (auto& worker : workers) {
+        total += worker.busy_ns();
+        busiest = std::max(busiest, worker.busy_ns());
     }
+
+    return (total == 0) ? 1 : static_cast<double>(busiest) * workers.size() / total;
 }
 
-std::chrono::nanoseconds Timer::getElapsedTime() const {
-    if (end_time != std::chrono::time_point<std::chrono::steady_clock>()) {
-        return end_time - start_time;
-    } else {
-        auto now = std::chrono::steady_clock::now();
-        return now - start_time;
+double ParallelRun::serial_fraction() const {
+    uint64_t work = serial_ns;
+    for (auto& worker : workers)
+        work += worker.busy_ns();
+
+    return (work == 0) ? 0 : static_cast<double>(serial_ns) / work;
+}
+
+double ParallelRun::speedup_bound() const {
+    uint64_t work = serial_ns, busiest = 0;
+    for (auto& worker : workers) {
+        work += worker.busy_ns();
+        busiest = std::max(busiest, worker.busy_ns());
     }
+
+    return (serial_ns + busiest == 0) ? 1 : static_cast<double>(work) / (serial_ns + busiest);
+}
+
+TimingLogger::TimingLogger() {
+#ifdef CHRONO_ENABLED
+    enabled = true;
+#else
+    enabled = false;
+#endif
 }
 
 TimingLogger& TimingLogger::instance() {
@@ -31,18 +62,273 @@ TimingLogger& TimingLogger::instance() {
     return logger;
 }
 
-Timer& TimingLogger::newTimer(std::string timerName) {
-    auto pair = timings.emplace(timerName, Timer());
-    return (*pair.first).second;
+void TimingLogger::enable(bool enabled) {
+    this->enabled.store(enabled, std::memory_order_relaxed);
+}
+
+ThreadTimings& TimingLogger::thread_timings() {
+    //the timings are owned by the logger, so that they outlive their thread
+    thread_local ThreadTimings* timings = nullptr;
+
+    if (timings == nullptr) {
+        auto lock = std::lock_guard(mutex);
+        threads.push_back(std::make_unique<ThreadTimings>());
+        timings = threads.back().get();
+        timings->thread = threads.size() - 1;
+    }
+
+    return *timings;
+}
+
+std::vector<TimingStats> TimingLogger::collect() {
+    auto lock = std::lock_guard(mutex);
+
+    std::vector<TimingStats> stats;
+    for (auto& thread : threads) {
+        auto thread_lock = std::lock_guard(thread->mutex);
+        stats.insert(stats.end(), thread->stats.begin(), thread->stats.end());
+    }
+
+    return stats;
+}
+
+void TimingLogger::record_run(ParallelRun run) {
+    auto lock = std::lock_guard(mutex);
+    runs.push_back(std::move(run));
 }
 
-void TimingLogger::logTimers() {
-    std::cout << std::setw(12) << std::right << "Time (ms)" << " | " << std::left << "Timer/Sequence Name" << std::endl;
-    for(auto const& [timer_name, timer] : timings) {
-        auto elapsed_time = timer.getElapsedTime();
-        auto elapsed_time_ms = elapsed_time.count() / 1000000.0;
-        std::cout << std::setw(12) << std::right << std::fixed << 
-            std::setprecision(3) << elapsed_time_ms << " | " <<
-            std::left << timer_name << std::endl;
+std::vector<ParallelRun> TimingLogger::parallel_runs() {
+    auto lock = std::lock_guard(mutex);
+    return runs;
+}
+
+//the stats of the same path on different threads summed up, with the number of threads as the thread field.
+std::vector<TimingStats> merge_threads(const std::vector<TimingStats>& stats) {
+    std::vector<TimingStats> merged;
+    std::unordered_map<std::string, size_t> indexes;
+
+    for (auto& entry : stats) {
+        auto [iter, inserted] = indexes.emplace(entry.path, merged.size());
+        if (inserted) {
+            merged.push_back(entry);
+            merged.back().thread = 1;
+            continue;
+        }
+
+        auto& total = merged[iter->second];
+        total.thread++;
+        total.count += entry.count;
+        total.total_ns += entry.total_ns;
+        total.min_ns = std::min(total.min_ns, entry.min_ns);
+        total.max_ns = std::max(total.max_ns, entry.max_ns);
+    }
+
+    //children right after their parent, siblings in the order they were run. as a scope is recorded when
+    //it stops, the first-seen order of the paths is a post-order, which still orders the siblings.
+    std::vector<std::pair<std::vector<size_t>, TimingStats>> keyed;
+    for (auto& entry : merged) {
+        std::vector<size_t> key;
+        for (auto end = entry.path.find('/');; end = entry.path.find('/', end + 1)) {
+            auto prefix = indexes.find(entry.path.substr(0, end));
+            key.push_back((prefix != indexes.end()) ? prefix->second : indexes[entry.path]);
+            if (end == std::string::npos) break;
+        }
+        keyed.emplace_back(std::move(key), entry);
+    }
+
+    std::sort(keyed.begin(), keyed.end(), [](auto& a, auto& b) { return a.first < b.first; });
+    for (size_t i = 0; i < keyed.size(); i++)
+        merged[i] = keyed[i].second;
+
+    return merged;
+}
+
+inline double to_ms(uint64_t nanoseconds) {
+    return nanoseconds / 1000000.0;
+}
+
+void TimingLogger::logTimers(std::ostream& output) {
+    output << std::setw(12) << std::right << "Time (ms)" << " | " << std::setw(8) << "Calls" << " | "
+        << std::setw(12) << "Max (ms)" << " | " << std::setw(7) << "Threads" << " | " << std::left << "Scope" << std::endl;
+
+    for (auto& entry : merge_threads(collect())) {
+        auto depth = std::count(entry.path.begin(), entry.path.end(), '/');
+        auto name = entry.path.substr(entry.path.rfind('/') + 1);
+
+        output << std::setw(12) << std::right << std::fixed << std::setprecision(3) << to_ms(entry.total_ns) << " | "
+            << std::setw(8) << entry.count << " | " << std::setw(12) << to_ms(entry.max_ns) << " | "
+            << std::setw(7) << entry.thread << " | " << std::left << std::string(2 * depth, ' ') << name << std::endl;
+    }
+
+    for (auto& run : parallel_runs()) {
+        output << std::endl << std::fixed << std::setprecision(3) << run.encoder << ", " << run.workers.size() << " workers: "
+            << to_ms(run.total_ns) << " ms, serial " << to_ms(run.serial_ns) << " ms (merge " << to_ms(run.merge_ns)
+            << " ms), serial fraction " << run.serial_fraction() << ", imbalance " << run.imbalance()
+            << ", speedup bound " << run.speedup_bound() << std::endl;
+
+        output << std::setw(8) << std::right << "Worker" << " | " << std::setw(10) << "Wait (ms)" << " | "
+            << std::setw(14) << "Histogram (ms)" << " | " << std::setw(11) << "Encode (ms)" << " | "
+            << std::setw(12) << "Bytes in" << " | " << std::setw(12) << "Bits out" << std::endl;
+        for (size_t i = 0; i < run.workers.size(); i++) {
+            auto& worker = run.workers[i];
+            output << std::setw(8) << i << " | " << std::setw(10) << to_ms(worker.queue_wait_ns) << " | "
+                << std::setw(14) << to_ms(worker.histogram_ns) << " | " << std::setw(11) << to_ms(worker.encode_ns) << " | "
+                << std::setw(12) << worker.bytes_in << " | " << std::setw(12) << worker.bits_out << std::endl;
+        }
+    }
+    output << std::left;
+}
+
+void TimingLogger::writeJson(std::ostream& output) {
+    auto stats = collect();
+
+    output << "{\"scopes\": [";
+    auto merged = merge_threads(stats);
+    for (size_t i = 0; i < merged.size(); i++) {
+        auto& entry = merged[i];
+        output << ((i == 0) ? "\n" : ",\n") << "  {\"path\": \"" << entry.path << "\", \"count\": " << entry.count
+            << ", \"total_ms\": " << to_ms(entry.total_ns) << ", \"mean_ms\": " << to_ms(entry.total_ns / entry.count)
+            << ", \"min_ms\": " << to_ms(entry.min_ns) << ", \"max_ms\": " << to_ms(entry.max_ns) << ", \"threads\": [";
+
+        bool first = true;
+        for (auto& thread_entry : stats) {
+            if (thread_entry.path != entry.path) continue;
+            output << (first ? "" : ", ") << "{\"thread\": " << thread_entry.thread << ", \"count\": " << thread_entry.count
+                << ", \"total_ms\": " << to_ms(thread_entry.total_ns) << "}";
+            first = false;
+        }
+        output << "]}";
+    }
+
+    output << "\n], \"parallel_runs\": [";
+    auto runs = parallel_runs();
+    for (size_t i = 0; i < runs.size(); i++) {
+        auto& run = runs[i];
+        output << ((i == 0) ? "\n" : ",\n") << "  {\"encoder\": \"" << run.encoder << "\", \"total_ms\": " << to_ms(run.total_ns)
+            << ", \"serial_ms\": " << to_ms(run.serial_ns) << ", \"merge_ms\": " << to_ms(run.merge_ns)
+            << ", \"serial_fraction\": " << run.serial_fraction() << ", \"imbalance\": " << run.imbalance()
+            << ", \"speedup_bound\": " << run.speedup_bound() << ", \"workers\": [";
+
+        for (size_t j = 0; j < run.workers.size(); j++) {
+            auto& worker = run.workers[j];
+            output << ((j == 0) ? "" : ", ") << "{\"queue_wait_ms\": " << to_ms(worker.queue_wait_ns)
+                << ", \"histogram_ms\": " << to_ms(worker.histogram_ns) << ", \"encode_ms\": " << to_ms(worker.encode_ns)
+                << ", \"bytes_in\": " << worker.bytes_in << ", \"bits_out\": " << worker.bits_out << "}";
+        }
+        output << "]}";
+    }
+    output << "\n]}" << std::endl;
+}
+
+void TimingLogger::writeCsv(std::ostream& output) {
+    output << "path,thread,count,total_ms,mean_ms,min_ms,max_ms\n";
+    for (auto& entry : collect()) {
+        output << entry.path << ',' << entry.thread << ',' << entry.count << ',' << to_ms(entry.total_ns) << ','
+            << to_ms(entry.total_ns / entry.count) << ',' << to_ms(entry.min_ns) << ',' << to_ms(entry.max_ns) << '\n';
+    }
+    output << std::flush;
+}
+
+//one row per worker of each run, the run numbered in the order it ended.
+void TimingLogger::writeWorkersCsv(std::ostream& output) {
+    output << "run,encoder,worker,queue_wait_ms,histogram_ms,encode_ms,bytes_in,bits_out,serial_fraction,imbalance\n";
+    auto runs = parallel_runs();
+    for (size_t i = 0; i < runs.size(); i++) {
+        auto& run = runs[i];
+        for (size_t j = 0; j < run.workers.size(); j++) {
+            auto& worker = run.workers[j];
+            output << i << ',' << run.encoder << ',' << j << ',' << to_ms(worker.queue_wait_ns) << ','
+                << to_ms(worker.histogram_ns) << ',' << to_ms(worker.encode_ns) << ',' << worker.bytes_in << ','
+                << worker.bits_out << ',' << run.serial_fraction() << ',' << run.imbalance() << '\n';
+        }
+    }
+    output << std::flush;
+}
+
+void TimingLogger::clear() {
+    auto lock = std::lock_guard(mutex);
+    runs.clear();
+    for (auto& thread : threads) {
+        auto thread_lock = std::lock_guard(thread->mutex);
+        thread->stats.clear();
+        thread->indexes.clear();
+    }
+}
+
+TimingScope::TimingScope(const char* name)
+    : thread(nullptr)
+{
+    auto& logger = TimingLogger::instance();
+    if (!logger.is_enabled()) return;
+
+    thread = &logger.thread_timings();
+    parent_length = thread->path.size();
+    if (parent_length > 0) thread->path += '/';
+    thread->path += name;
+
+    path = thread->path;
+    start_time = std::chrono::steady_clock::now();
+}
+
+TimingScope::~TimingScope() {
+    stop();
+}
+
+void TimingScope::stop() {
+    if (thread == nullptr) return;
+
+    auto elapsed = std::chrono::steady_clock::now() - start_time;
+    thread->record(path, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+
+    //a parent stopped before its children has already closed them
+    if (thread->path.size() >= path.size())
+        thread->path.resize(parent_length);
+    thread = nullptr;
+}
+
+ParallelProfile::ParallelProfile(const char* encoder, size_t workers)
+    : serial_ns(0), merge_ns(0), start_time(std::chrono::steady_clock::now())
+{
+    run.encoder = encoder;
+    run.workers.resize(workers);
+}
+
+ParallelProfile::~ParallelProfile() {
+    auto& logger = TimingLogger::instance();
+    if (!logger.is_enabled()) return;
+
+    run.total_ns = elapsed_ns(start_time);
+    run.serial_ns = serial_ns.load(std::memory_order_relaxed);
+    run.merge_ns = merge_ns.load(std::memory_order_relaxed);
+    logger.record_run(std::move(run));
+}
+
+ProfileReport::ProfileReport(const std::string& file)
+    : file(file) {}
+
+ProfileReport::~ProfileReport() {
+    auto& logger = TimingLogger::instance();
+    if (!logger.is_enabled()) return;
+
+    auto has_extension = [&](const std::string& extension) {
+        return file.size() > extension.size() && file.compare(file.size() - extension.size(), extension.size(), extension) == 0;
+    };
+
+    if (file.empty()) {
+        logger.logTimers(std::cerr);
+    } else if (has_extension(".json")) {
+        auto output = std::ofstream(file);
+        logger.writeJson(output);
+    } else if (has_extension(".csv")) {
+        auto output = std::ofstream(file);
+        logger.writeCsv(output);
+
+        if (!logger.parallel_runs().empty()) {
+            auto workers_output = std::ofstream(file.substr(0, file.size() - 4) + "_workers.csv");
+            logger.writeWorkersCsv(workers_output);
+        }
+    } else {
+        auto output = std::ofstream(file);
+        logger.logTimers(output);
     }
 }
\ No newline at end of file
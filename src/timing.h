@@ -1,43 +1,184 @@
 #ifndef TIMING
 #define TIMING
 
-#include <string>
+#include <atomic>
 #include <chrono>
-#include <map>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//the timings of a scope path ("encode/frequencies") on a thread, over all the times it was run.
+struct TimingStats {
+    std::string path;
+    size_t thread;
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+};
+
+//the scopes of a thread: only the thread itself writes them, so its lock is never contended.
+struct ThreadTimings {
+    size_t thread;
+    std::string path;
+    std::mutex mutex;
+    std::vector<TimingStats> stats;
+    std::unordered_map<std::string, size_t> indexes;
 
-class Timer;
+    void record(const std::string& path, uint64_t elapsed_ns);
+};
+
+//the nanoseconds from start to now.
+inline uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+//what a worker of a parallel encoder did in one run: how long its tasks waited to be picked up,
+//how long it counted frequencies and encoded, and the size of its segment before and after.
+struct WorkerRecord {
+    uint64_t queue_wait_ns = 0;
+    uint64_t histogram_ns = 0;
+    uint64_t encode_ns = 0;
+    uint64_t bytes_in = 0;
+    uint64_t bits_out = 0;
+
+    inline uint64_t busy_ns() const {
+        return histogram_ns + encode_ns;
+    }
+};
 
+//one run of a parallel encoder. serial_ns is the time spent on the steps no number of workers
+//shortens (spawning, the table, the offsets, the merges), merge_ns the part of it spent merging
+//the results of the workers.
+struct ParallelRun {
+    std::string encoder;
+    uint64_t total_ns = 0;
+    uint64_t serial_ns = 0;
+    uint64_t merge_ns = 0;
+    std::vector<WorkerRecord> workers;
+
+    //the busiest worker against the mean, 1 when the load is even.
+    double imbalance() const;
+
+    //the serial share of the work done by a single worker, bounding the speedup to 1 / serial_fraction().
+    double serial_fraction() const;
+
+    //the speedup over a single worker these workers can reach, the busiest one being the last to finish.
+    double speedup_bound() const;
+};
+
+//collects the timings of every thread. profiling is off unless enabled at runtime (--profile)
+//or at build time (make all-chrono), and a scope then costs a single relaxed load.
 class TimingLogger {
 private:
-    std::map<std::string, Timer> timings;
+    std::atomic<bool> enabled;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadTimings>> threads;
+    std::vector<ParallelRun> runs;
 
 public:
     //singleton pattern
     static TimingLogger& instance();
 
-    Timer& newTimer(std::string timerName);
+    inline bool is_enabled() const {
+        return enabled.load(std::memory_order_relaxed);
+    }
+
+    void enable(bool enabled);
+
+    //the timings of the calling thread, registered on its first scope.
+    ThreadTimings& thread_timings();
+
+    //the stats of every thread, in the order their scopes were first run.
+    std::vector<TimingStats> collect();
+
+    void record_run(ParallelRun run);
+    std::vector<ParallelRun> parallel_runs();
 
-    void logTimers();
+    //the stats merged over the threads, as an indented table of the scope tree, then the parallel runs.
+    void logTimers(std::ostream& output);
+
+    void writeJson(std::ostream& output);
+    void writeCsv(std::ostream& output);
+    void writeWorkersCsv(std::ostream& output);
+
+    void clear();
 
 private:
-    TimingLogger() = default;
+    TimingLogger();
     TimingLogger(const TimingLogger&) = delete;
     TimingLogger(TimingLogger&&) = delete;
     TimingLogger& operator=(const TimingLogger&) = delete;
     TimingLogger& operator=(TimingLogger&&) = delete;
 };
 
-class Timer {
+//times a phase from its construction to stop() or its destruction. scopes opened on a thread
+//while another one is open are nested in it, their path being "parent/child".
+class TimingScope {
+private:
+    ThreadTimings* thread;
+    std::string path;
+    size_t parent_length;
+    std::chrono::steady_clock::time_point start_time;
+
+public:
+    explicit TimingScope(const char* name);
+    ~TimingScope();
+
+    TimingScope(const TimingScope&) = delete;
+    TimingScope& operator=(const TimingScope&) = delete;
+
+    void stop();
+};
+
+//the record of a run of a parallel encoder, handed to the logger on destruction if profiling is
+//enabled. each worker fills its own record, while the serial steps may be added from any thread.
+class ParallelProfile {
+private:
+    ParallelRun run;
+    std::atomic<uint64_t> serial_ns;
+    std::atomic<uint64_t> merge_ns;
+    std::chrono::steady_clock::time_point start_time;
+
+public:
+    ParallelProfile(const char* encoder, size_t workers);
+    ~ParallelProfile();
+
+    ParallelProfile(const ParallelProfile&) = delete;
+    ParallelProfile& operator=(const ParallelProfile&) = delete;
+
+    inline WorkerRecord& worker(size_t worker) {
+        return run.workers[worker];
+    }
+
+    inline void add_serial(std::chrono::steady_clock::time_point start) {
+        serial_ns.fetch_add(elapsed_ns(start), std::memory_order_relaxed);
+    }
+
+    inline void add_merge(std::chrono::steady_clock::time_point start) {
+        auto elapsed = elapsed_ns(start);
+        serial_ns.fetch_add(elapsed, std::memory_order_relaxed);
+        merge_ns.fetch_add(elapsed, std::memory_order_relaxed);
+    }
+};
+
+//reports the timings when it goes out of scope, if profiling is enabled: as a table on the
+//standard error, or to a file as JSON or CSV according to its extension. the CSV of the
+//workers of the parallel runs goes next to it, as <name>_workers.csv.
+class ProfileReport {
 private:
-    std::chrono::time_point<std::chrono::steady_clock> start_time;
-    std::chrono::time_point<std::chrono::steady_clock> end_time;
+    std::string file;
 
 public:
-    Timer();
-    ~Timer();
+    ProfileReport(const std::string& file);
+    ~ProfileReport();
 
-    void stopTimer();
-    std::chrono::nanoseconds getElapsedTime() const;
+    ProfileReport(const ProfileReport&) = delete;
+    ProfileReport& operator=(const ProfileReport&) = delete;
 };
 
 #endif
\ No newline at end of file
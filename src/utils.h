@@ -1,6 +1,7 @@
 #ifndef UTILS
 #define UTILS
 
+#include <cstdint>
 #include <iostream>
 
 template<typename T>
@@ -14,6 +15,18 @@ inline T positive_div_ceil(T dividend, T divisor) {
     }
 }
 
+//64 bit FNV-1a hash of a range of bytes, used to identify serialized tables.
+template<class Iter>
+inline uint64_t fnv1a_hash(Iter begin, Iter end) {
+    uint64_t hash = 14695981039346656037ull;
+    for (auto iter = begin; iter != end; iter++) {
+        hash ^= static_cast<unsigned char>(*iter);
+        hash *= 1099511628211ull;
+    }
+
+    return hash;
+}
+
 //pre-generated masks to extract a certain number of bits from a byte.
 const static byte rightByteMasks[] = {
     0,